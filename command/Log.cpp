@@ -57,6 +57,20 @@ static void printBasicInfo(std::ostream& output) {
 
 
 
+static thread_local ErrorCapture* currentCapture = nullptr;
+
+ErrorCapture::ErrorCapture() :
+    previous(currentCapture)
+{
+    currentCapture = this;
+}
+
+ErrorCapture::~ErrorCapture() {
+    currentCapture = previous;
+}
+
+
+
 ErrorLog::ErrorLog() {
     output.open(LOG_PATH);
 
@@ -73,6 +87,18 @@ ErrorLog& ErrorLog::getInstance() {
 }
 
 void ErrorLog::log(const std::string& msg, const bool& timestamp) {
+    // Captured errors only need to be kept for the thread that captured them
+    if (currentCapture != nullptr)
+    {
+        currentCapture->errors.push_back(msg);
+        if (currentCapture->errors.size() > MAX_ERRORS)
+        {
+            currentCapture->errors.pop_front();
+        }
+        return;
+    }
+
+    std::scoped_lock lock(mut);
     if(timestamp) output << "[" << ProgramTime::getTimeStr() << "] ";
     output << msg << std::endl;
     lastErrors.push_back(msg);
@@ -84,8 +110,9 @@ void ErrorLog::log(const std::string& msg, const bool& timestamp) {
 
 std::string ErrorLog::getLastErrors() const
 {
+    std::scoped_lock lock(mut);
     std::string retStr = "";
-    for (auto& error : lastErrors)
+    for (auto& error : (currentCapture != nullptr ? currentCapture->errors : lastErrors))
     {
         retStr += error + "\n";
     }
@@ -94,6 +121,13 @@ std::string ErrorLog::getLastErrors() const
 
 void ErrorLog::clearLastErrors()
 {
+    if (currentCapture != nullptr)
+    {
+        currentCapture->errors.clear();
+        return;
+    }
+
+    std::scoped_lock lock(mut);
     lastErrors.clear();
 }
 
@@ -115,6 +149,7 @@ DebugLog& DebugLog::getInstance() {
 }
 
 void DebugLog::log(const std::string& msg, const bool& timestamp) {
+    std::scoped_lock lock(mut);
     if(timestamp) output << "[" << ProgramTime::getTimeStr() << "] ";
     output << msg << std::endl;
 }
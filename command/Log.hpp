@@ -3,6 +3,7 @@
 #include <string>
 #include <fstream>
 #include <list>
+#include <mutex>
 
 #include <seedgen/config.hpp>
 #include <utility/path.hpp>
@@ -32,12 +33,30 @@ public:
 
 
 
+// While in scope, errors logged on the thread which created it are collected here
+// instead of going to the error log file. This keeps the errors from generations
+// which are running at the same time apart from each other
+class ErrorCapture {
+private:
+    std::list<std::string> errors;
+    ErrorCapture* previous = nullptr;
+
+    friend class ErrorLog;
+public:
+    ErrorCapture();
+    ~ErrorCapture();
+
+    ErrorCapture(const ErrorCapture&) = delete;
+    ErrorCapture& operator=(const ErrorCapture&) = delete;
+};
+
 class ErrorLog {
 private:
     static constexpr size_t MAX_ERRORS = 5;
 
     std::ofstream output;
     std::list<std::string> lastErrors;
+    mutable std::mutex mut;
 
     ErrorLog();
     ~ErrorLog();
@@ -80,6 +99,7 @@ public:
 class DebugLog {
 private:
     std::ofstream output;
+    std::mutex mut;
 
     DebugLog();
     ~DebugLog();
@@ -1,11 +1,14 @@
 #include "RandoSession.hpp"
 
 
+#include <cassert>
 #include <cstring>
 #include <algorithm>
 #include <functional>
 #include <filesystem>
 #include <memory>
+#include <mutex>
+#include <optional>
 #include <unordered_map>
 #include <fstream>
 #include <string>
@@ -45,6 +48,10 @@ static BS::thread_pool workerThreads(3);
 static BS::thread_pool workerThreads(std::thread::hardware_concurrency() ? std::thread::hardware_concurrency() : 4);
 #endif
 
+#ifndef DEVKITPRO
+static constexpr uintmax_t REPACK_CACHE_SIZE = 256 * 1024 * 1024;
+#endif
+
 static std::atomic<size_t> total_num_tasks = 0;
 static std::atomic<size_t> num_completed_tasks = 0;
 
@@ -140,6 +147,11 @@ bool RandoSession::init(const fspath& gameBaseDir, const fspath& randoOutputDir)
         return false;
     }
 
+    // Console storage is slow and small, so only keep compressed files around on desktop
+    #ifndef DEVKITPRO
+        repackCache.init(Utility::get_app_save_path() / "repack_cache", REPACK_CACHE_SIZE);
+    #endif
+
     clearCache();
     initialized = true;
 
@@ -150,90 +162,97 @@ bool RandoSession::extractFile(std::shared_ptr<CacheEntry> current)
 {
     RawFile* parentData = dynamic_cast<RawFile*>(current->parent->data.get());
 
+    // Parents mapped from the base dump are parsed in place instead of through their stream
+    std::optional<Utility::ViewStream> mappedInput;
+    std::istream* parentInput = nullptr;
+    if(parentData != nullptr) {
+        parentInput = parentData->source.isOpen() ? &mappedInput.emplace(parentData->source.view()) : static_cast<std::istream*>(&parentData->data);
+    }
+
     using Fmt = CacheEntry::Format;
     switch(current->storedFormat) {
         case Fmt::BDT:
         {
             if(parentData == nullptr) return false;
             current->data = std::make_unique<FileTypes::BDTFile>();
-            dynamic_cast<FileTypes::BDTFile*>(current->data.get())->loadFromBinary(parentData->data);
+            dynamic_cast<FileTypes::BDTFile*>(current->data.get())->loadFromBinary(*parentInput);
         }
         break;
         case Fmt::BFLIM:
         {
             if(parentData == nullptr) return false;
             current->data = std::make_unique<FileTypes::FLIMFile>();
-            dynamic_cast<FileTypes::FLIMFile*>(current->data.get())->loadFromBinary(parentData->data);
+            dynamic_cast<FileTypes::FLIMFile*>(current->data.get())->loadFromBinary(*parentInput);
         }
         break;
         case Fmt::BFLYT:
         {
             if(parentData == nullptr) return false;
             current->data = std::make_unique<FileTypes::FLYTFile>();
-            dynamic_cast<FileTypes::FLYTFile*>(current->data.get())->loadFromBinary(parentData->data);
+            dynamic_cast<FileTypes::FLYTFile*>(current->data.get())->loadFromBinary(*parentInput);
         }
         break;
         case Fmt::BFRES:
         {
             if(parentData == nullptr) return false;
             current->data = std::make_unique<FileTypes::resFile>();
-            dynamic_cast<FileTypes::resFile*>(current->data.get())->loadFromBinary(parentData->data);
+            dynamic_cast<FileTypes::resFile*>(current->data.get())->loadFromBinary(*parentInput);
         }
         break;
         case Fmt::CHARTS:
         {
             if(parentData == nullptr) return false;
             current->data = std::make_unique<FileTypes::ChartList>();
-            dynamic_cast<FileTypes::ChartList*>(current->data.get())->loadFromBinary(parentData->data);
+            dynamic_cast<FileTypes::ChartList*>(current->data.get())->loadFromBinary(*parentInput);
         }
         break;
         case Fmt::DZX:
         {
             if(parentData == nullptr) return false;
             current->data = std::make_unique<FileTypes::DZXFile>();
-            dynamic_cast<FileTypes::DZXFile*>(current->data.get())->loadFromBinary(parentData->data.seekg(0, std::ios::beg));
+            dynamic_cast<FileTypes::DZXFile*>(current->data.get())->loadFromBinary(parentData->bytes());
         }
         break;
         case Fmt::ELF:
         {
             if(parentData == nullptr) return false;
             current->data = std::make_unique<FileTypes::ELF>();
-            dynamic_cast<FileTypes::ELF*>(current->data.get())->loadFromBinary(parentData->data);
+            dynamic_cast<FileTypes::ELF*>(current->data.get())->loadFromBinary(parentData->bytes());
         }
         break;
         case Fmt::EVENTS:
         {
             if(parentData == nullptr) return false;
             current->data = std::make_unique<FileTypes::EventList>();
-            dynamic_cast<FileTypes::EventList*>(current->data.get())->loadFromBinary(parentData->data);
+            dynamic_cast<FileTypes::EventList*>(current->data.get())->loadFromBinary(*parentInput);
         }
         break;
         case Fmt::JPC:
         {
             if(parentData == nullptr) return false;
             current->data = std::make_unique<FileTypes::JPC>();
-            dynamic_cast<FileTypes::JPC*>(current->data.get())->loadFromBinary(parentData->data);
+            dynamic_cast<FileTypes::JPC*>(current->data.get())->loadFromBinary(*parentInput);
         }
         break;
         case Fmt::MSBP:
         {
             if(parentData == nullptr) return false;
             current->data = std::make_unique<FileTypes::MSBPFile>();
-            dynamic_cast<FileTypes::MSBPFile*>(current->data.get())->loadFromBinary(parentData->data);
+            dynamic_cast<FileTypes::MSBPFile*>(current->data.get())->loadFromBinary(*parentInput);
         }
         break;
         case Fmt::MSBT:
         {
             if(parentData == nullptr) return false;
             current->data = std::make_unique<FileTypes::MSBTFile>();
-            dynamic_cast<FileTypes::MSBTFile*>(current->data.get())->loadFromBinary(parentData->data);
+            dynamic_cast<FileTypes::MSBTFile*>(current->data.get())->loadFromBinary(parentData->bytes());
         }
         break;
         case Fmt::RPX:
         {
             if(parentData == nullptr) return false;
             current->data = std::make_unique<RawFile>();
-            if (RPXError err = FileTypes::rpx_decompress(parentData->data, dynamic_cast<RawFile*>(current->data.get())->data); err != RPXError::NONE)
+            if (RPXError err = FileTypes::rpx_decompress(*parentInput, dynamic_cast<RawFile*>(current->data.get())->data); err != RPXError::NONE)
             {
                 ErrorLog::getInstance().log(std::string("Encountered RPXError on line " TOSTRING(__LINE__) " of ") + __FILENAME__);
                 return false;
@@ -244,30 +263,35 @@ bool RandoSession::extractFile(std::shared_ptr<CacheEntry> current)
         {
             if(parentData == nullptr) return false;
             current->data = std::make_unique<FileTypes::SARCFile>();
-            dynamic_cast<FileTypes::SARCFile*>(current->data.get())->loadFromBinary(parentData->data);
+            dynamic_cast<FileTypes::SARCFile*>(current->data.get())->loadFromBinary(parentData->bytes());
         }
         break;
         case Fmt::YAZ0:
         {
             if(parentData == nullptr) return false;
             current->data = std::make_unique<RawFile>();
-            if (YAZ0Error err = FileTypes::yaz0Decode(parentData->data, dynamic_cast<RawFile*>(current->data.get())->data); err != YAZ0Error::NONE)
+            // Decode straight from the parent's buffer and hand the result to the new stream without copying it
+            std::string decoded;
+            const std::string_view encoded = parentData->bytes();
+            if (YAZ0Error err = FileTypes::yaz0Decode(encoded, decoded); err != YAZ0Error::NONE)
             {
                 ErrorLog::getInstance().log(std::string("Encountered YAZ0Error on line " TOSTRING(__LINE__) " of ") + __FILENAME__);
                 return false;
             }
+            dynamic_cast<RawFile*>(current->data.get())->data.str(std::move(decoded));
         }
         break;
         case Fmt::STREAM:
         {
             if (current->parent->storedFormat == Fmt::SARC) {
-                const std::string* file = dynamic_cast<FileTypes::SARCFile*>(current->parent->data.get())->getFile(current->element.string());
+                std::string* file = dynamic_cast<FileTypes::SARCFile*>(current->parent->data.get())->getFile(current->element.string());
                 if(file == nullptr) {
                     ErrorLog::getInstance().log("Could not find " + current->element.string() + " in SARC");
                     return false;
                 }
 
-                current->data = std::make_unique<RawFile>(*file);
+                // The member gets written back when this is repacked, so take it instead of copying it
+                current->data = std::make_unique<RawFile>(std::move(*file));
             }
             else if (current->parent->storedFormat == Fmt::BFRES) {
                 const auto& files = dynamic_cast<FileTypes::resFile*>(current->parent->data.get())->files;
@@ -288,7 +312,13 @@ bool RandoSession::extractFile(std::shared_ptr<CacheEntry> current)
         case Fmt::ROOT:
         {
             current->data = std::make_unique<RawFile>();
-            if(Utility::getFileContents((baseDir / current->element), dynamic_cast<RawFile*>(current->data.get())->data) != 0) return false;
+            RawFile* file = dynamic_cast<RawFile*>(current->data.get());
+            // Children only read this before they're repacked into it, so it can be mapped
+            // instead of read. Anything that gets modified directly needs its own copy
+            if(current->actions.empty() && !current->children.empty()) {
+                if(file->source.open(baseDir / current->element) != 0) return false;
+            }
+            else if(Utility::getFileContents((baseDir / current->element), file->data) != 0) return false;
         }
         break;
         case Fmt::EMPTY:
@@ -297,7 +327,10 @@ bool RandoSession::extractFile(std::shared_ptr<CacheEntry> current)
             return false;
     }
 
-    if(parentData != nullptr) parentData->data.str(std::string()); // clear parent sstream, don't need it
+    if(parentData != nullptr) { // clear parent data, don't need it
+        parentData->data.str(std::string());
+        parentData->source.close();
+    }
     return true;
 }
 
@@ -338,13 +371,17 @@ bool RandoSession::repackFile(std::shared_ptr<CacheEntry> current)
         case Fmt::DZX:
         {
             if(parentData == nullptr) return false;
-            dynamic_cast<FileTypes::DZXFile*>(current->data.get())->writeToStream(parentData->data.seekp(0, std::ios::beg));
+            std::string repacked;
+            dynamic_cast<FileTypes::DZXFile*>(current->data.get())->writeToBuffer(repacked);
+            parentData->replaceData(std::move(repacked));
         }
         return true;
         case Fmt::ELF:
         {
             if(parentData == nullptr) return false;
-            dynamic_cast<FileTypes::ELF*>(current->data.get())->writeToStream(parentData->data.seekp(0, std::ios::beg));
+            std::string repacked;
+            dynamic_cast<FileTypes::ELF*>(current->data.get())->writeToBuffer(repacked);
+            parentData->replaceData(std::move(repacked));
         }
         return true;
         case Fmt::EVENTS:
@@ -368,7 +405,9 @@ bool RandoSession::repackFile(std::shared_ptr<CacheEntry> current)
         case Fmt::MSBT:
         {
             if(parentData == nullptr) return false;
-            dynamic_cast<FileTypes::MSBTFile*>(current->data.get())->writeToStream(parentData->data.seekp(0, std::ios::beg));
+            std::string repacked;
+            dynamic_cast<FileTypes::MSBTFile*>(current->data.get())->writeToBuffer(repacked);
+            parentData->replaceData(std::move(repacked));
         }
         return true;
         case Fmt::RPX:
@@ -384,18 +423,34 @@ bool RandoSession::repackFile(std::shared_ptr<CacheEntry> current)
         case Fmt::SARC:
         {
             if(parentData == nullptr) return false;
-            dynamic_cast<FileTypes::SARCFile*>(current->data.get())->writeToStream(parentData->data.seekp(0, std::ios::beg));
+            std::string repacked;
+            dynamic_cast<FileTypes::SARCFile*>(current->data.get())->writeToBuffer(repacked);
+            parentData->replaceData(std::move(repacked));
         }
         return true;
         case Fmt::YAZ0:
         {
             if(parentData == nullptr) return false;
             //const uint32_t compressLevel = current->parent->storedFormat == Fmt::ROOT ? 1 : 9;
-            if (YAZ0Error err = FileTypes::yaz0Encode(dynamic_cast<RawFile*>(current->data.get())->data, parentData->data.seekp(0, std::ios::beg), 7); err != YAZ0Error::NONE)
+            const uint32_t compressLevel = 7;
+            const std::string_view decoded = dynamic_cast<RawFile*>(current->data.get())->data.view();
+
+            std::string encoded;
+
+            // Reuse the compressed data from an earlier run if this file came out the same
+            const std::string cacheKey = repackCache.getKey("YAZ0", compressLevel, decoded);
+            if (!repackCache.load(cacheKey, encoded))
             {
-                ErrorLog::getInstance().log(std::string("Encountered YAZ0Error on line " TOSTRING(__LINE__) " of ") + __FILENAME__);
-                return false;
+                // This already runs on one of the worker threads, so don't start any more
+                if (YAZ0Error err = FileTypes::yaz0Encode(decoded, encoded, compressLevel, 1); err != YAZ0Error::NONE)
+                {
+                    ErrorLog::getInstance().log(std::string("Encountered YAZ0Error on line " TOSTRING(__LINE__) " of ") + __FILENAME__);
+                    return false;
+                }
+                repackCache.store(cacheKey, encoded);
             }
+            // Hand the encoded data to the parent instead of copying it
+            parentData->replaceData(std::move(encoded));
         }
         return true;
         case Fmt::STREAM:
@@ -407,7 +462,7 @@ bool RandoSession::repackFile(std::shared_ptr<CacheEntry> current)
                     return false;
                 }
 
-                arc->files[current->element.string()] = dynamic_cast<RawFile*>(current->data.get())->data.str();
+                arc->files[current->element.string()] = dynamic_cast<RawFile*>(current->data.get())->releaseData();
             }
             else if (current->parent->storedFormat == Fmt::BFRES) {
                 FileTypes::resFile* file = dynamic_cast<FileTypes::resFile*>(current->parent->data.get());
@@ -422,9 +477,17 @@ bool RandoSession::repackFile(std::shared_ptr<CacheEntry> current)
         return true;
         case Fmt::ROOT:
         {
+            #ifndef DEVKITPRO
+                // First time setup can hard link files to the base dump, don't write through the link
+                std::error_code ec;
+                if(const uintmax_t links = std::filesystem::hard_link_count(outputDir / current->element, ec); !ec && links > 1) {
+                    std::filesystem::remove(outputDir / current->element, ec);
+                }
+            #endif
+
             std::ofstream output(outputDir / current->element, std::ios::binary);
             if(!output.is_open()) return false;
-            const std::string& data = dynamic_cast<RawFile*>(current->data.get())->data.str();
+            const std::string_view data = dynamic_cast<RawFile*>(current->data.get())->data.view();
             output.write(data.data(), data.size());
         }
         return true;
@@ -515,7 +578,7 @@ bool RandoSession::copyToGameFile(const fspath& source, const fspath& relPath, c
 
         std::string fileData = "";
         if(Utility::getFileContents(source, fileData, resourceFile) != 0) return false; //TODO: proper time against rdbuf
-        dst->data.str(fileData); 
+        dst->data.str(std::move(fileData));
 
         return true;
     });
@@ -530,12 +593,49 @@ bool RandoSession::restoreGameFile(const fspath& relPath) { // Restores a file f
     return true;
 }
 
+// Children read from and repack into their parent's data, so siblings take turns
+// with it. Roots come from disk and write to their own file, so they don't wait
+std::unique_lock<std::mutex> RandoSession::lockParentData(const std::shared_ptr<CacheEntry>& entry) {
+    if(entry->parent->parent == nullptr) return {};
+
+    return std::unique_lock<std::mutex>(entry->parent->dataMutex);
+}
+
+void RandoSession::queueEntry(std::shared_ptr<CacheEntry> entry) {
+    {
+        std::scoped_lock lock(readyMutex);
+        readyEntries.push_back(entry);
+    }
+    workerThreads.push_task(&RandoSession::runNextEntry, this);
+}
+
+// Each queued entry gets one task, but tasks take whichever entry was queued last.
+// Children get worked on before any new roots are opened, which keeps only a few
+// files' data in memory at once
+void RandoSession::runNextEntry() {
+    std::shared_ptr<CacheEntry> entry = nullptr;
+    {
+        std::scoped_lock lock(readyMutex);
+        entry = readyEntries.back();
+        readyEntries.pop_back();
+    }
+    handleChildren(entry->element, entry);
+}
+
 bool RandoSession::handleChildren(const fspath filename, std::shared_ptr<CacheEntry> current) {
     if(current->parent->parent == nullptr) { // only print start of chain to avoid spam
         Utility::platformLog("Working on " + filename.string());
     }
     // extract this level, move down tree
-    if(!extractFile(current)) return false;
+    bool extracted = false;
+    {
+        const auto lock = lockParentData(current);
+        extracted = extractFile(current);
+    }
+    if(!extracted) {
+        childFinished(current); // parent still gets repacked without this
+        return false;
+    }
 
     // has mods to stream (item location edits), handle these before filetype stuff
     if(current->children.size() == 1 && current->actions.size() != 0 && dynamic_cast<RawFile*>(current->data.get()) != nullptr) {
@@ -549,17 +649,34 @@ bool RandoSession::handleChildren(const fspath filename, std::shared_ptr<CacheEn
         for(auto& action : current->actions) {
             action(this, current->data.get());
         }
+
+        finishEntry(current);
+        return true;
     }
-    else { // modify, repack children
-        for(auto& [filename, child] : current->children) {
-            if(child->getNumPrereqs() > 0 || child->isFinished() == true) continue; // skip this child, prereq did/will do it
 
-            RandoSession::handleChildren(filename, child);
-        }
+    // modify, repack children as their own tasks, whichever finishes last repacks this level
+    current->incrementUnfinishedChildren(); // keep this level open until every child is queued
+    for(auto& [filename, child] : current->children) {
+        if(child->getNumPrereqs() > 0 || !child->claimQueue()) continue; // skip this child, prereq did/will do it
+
+        current->incrementUnfinishedChildren();
+        queueEntry(child);
+    }
+    if(current->decrementUnfinishedChildren() == 0) {
+        finishEntry(current);
     }
 
+    return true;
+}
+
+void RandoSession::finishEntry(std::shared_ptr<CacheEntry> current) {
+    assert(!current->isFinished() && current->numUnfinishedChildren == 0); // each entry is repacked once, after all its children
+
     // repack this level
-    repackFile(current);
+    {
+        const auto lock = lockParentData(current);
+        repackFile(current);
+    }
 
     current->setFinished();
 
@@ -567,14 +684,14 @@ bool RandoSession::handleChildren(const fspath filename, std::shared_ptr<CacheEn
     for(auto& dependent : current->dependents) {
         // check if this is the last dependency
         if(dependent->decrementPrereq() > 0) continue; // decrement returns new value
+        if(!dependent->claimQueue()) continue; // its parent's loop got to it first
 
         // handle the data
         if(current->isSibling(dependent)) { //IMPROVEMENT: more precise sibling checks, filename stuff
-            RandoSession::handleChildren(filename / dependent->element, dependent);
-        }
-        else { //IMPROVEMENT: check entry is root, handle other edge cases
-            workerThreads.push_task(&RandoSession::handleChildren, this, dependent->element, dependent); // add root of this other chain
+            dependent->parent->incrementUnfinishedChildren(); // its parent has to wait for it too
         }
+        //IMPROVEMENT: check entry is root, handle other edge cases
+        queueEntry(dependent);
     }
 
     // clear children once done
@@ -586,7 +703,16 @@ bool RandoSession::handleChildren(const fspath filename, std::shared_ptr<CacheEn
         UPDATE_DIALOG_VALUE(int(50.0f + 49.0f * (float(num_completed_tasks)/float(total_num_tasks)))); // also update progress bar
     }
 
-    return true;
+    childFinished(current);
+}
+
+// Repack the parent once its last child is done
+void RandoSession::childFinished(std::shared_ptr<CacheEntry> child) {
+    if(child->parent->parent == nullptr) return; // roots don't have anything to repack into
+
+    if(child->parent->decrementUnfinishedChildren() == 0) {
+        finishEntry(child->parent);
+    }
 }
 
 #ifdef DEVKITPRO
@@ -657,9 +783,35 @@ bool RandoSession::runFirstTimeSetup() {
  
         Utility::platformLog("Copying dump to output... (This may take a while)");
         UPDATE_DIALOG_LABEL("Copying dump to output... (This may take a while)");
-        std::filesystem::copy(baseDir / "code", outputDir / "code", std::filesystem::copy_options::recursive);
-        std::filesystem::copy(baseDir / "content", outputDir / "content", std::filesystem::copy_options::recursive);
-        std::filesystem::copy(baseDir / "meta", outputDir / "meta", std::filesystem::copy_options::recursive);
+
+        // Files that never get modified are cloned or linked instead of copied. Anything in the
+        // file cache gets written over when it's repacked, so it gets a real copy of its own
+        for(const char* folder : {"code", "content", "meta"}) {
+            if(!Utility::create_directories(outputDir / folder)) return false;
+
+            std::error_code ec;
+            for(auto it = std::filesystem::recursive_directory_iterator(baseDir / folder, ec); !ec && it != std::filesystem::recursive_directory_iterator(); it.increment(ec)) {
+                const fspath relPath = it->path().lexically_relative(baseDir);
+
+                if(it->is_directory()) {
+                    if(!Utility::create_directories(outputDir / relPath)) return false;
+                }
+                else if(it->is_regular_file()) {
+                    if(fileCache->children.contains(relPath.generic_string())) {
+                        std::filesystem::remove(outputDir / relPath, ec); // an earlier setup could have linked it
+                        if(!std::filesystem::copy_file(it->path(), outputDir / relPath, ec)) break;
+                    }
+                    else if(!Utility::linkOrCopyFile(it->path(), outputDir / relPath)) {
+                        return false;
+                    }
+                }
+            }
+
+            if(ec) {
+                ErrorLog::getInstance().log("Failed to copy " + Utility::toUtf8String(baseDir / folder) + " to output: " + ec.message());
+                return false;
+            }
+        }
     #endif
 
     setFirstTimeSetup(false);
@@ -685,11 +837,11 @@ bool RandoSession::modFiles()
     total_num_tasks = fileCache->children.size();
     for(auto& [filename, child] : fileCache->children) {
         // has dependency, it will add it when necessary
-        if(child->getNumPrereqs() > 0) {
+        if(child->getNumPrereqs() > 0 || !child->claimQueue()) {
             continue;
         }
 
-        workerThreads.push_task(&RandoSession::handleChildren, this, filename, child);  
+        queueEntry(child);
     }
     
     // uncache everything
@@ -701,6 +853,8 @@ bool RandoSession::modFiles()
 
     workerThreads.wait_for_tasks();
 
+    repackCache.prune();
+
     Utility::platformLog("Finished repacking files");
     LOG_TO_DEBUG("Finished repacking files");
 
@@ -6,9 +6,11 @@
 #include <unordered_map>
 #include <functional>
 #include <atomic>
+#include <mutex>
 
 #include <utility/path.hpp>
 #include <filetypes/baseFiletype.hpp>
+#include <command/RepackCache.hpp>
 
 
 
@@ -55,6 +57,9 @@ public:
         size_t incrementPrereq() { return ++numPrereqs; }
         size_t decrementPrereq() { return --numPrereqs; }
         size_t getNumPrereqs() const { return numPrereqs; }
+        size_t incrementUnfinishedChildren() { return ++numUnfinishedChildren; }
+        size_t decrementUnfinishedChildren() { return --numUnfinishedChildren; }
+        bool claimQueue() { return !queued.exchange(true); } // true for only the first caller, who queues the entry
         void setFinished() { finished = true; }
         bool isFinished() const { return finished; }
         const std::shared_ptr<CacheEntry> getParent() const { return parent; }
@@ -71,7 +76,10 @@ public:
         std::unique_ptr<FileType> data = nullptr;
         std::vector<Action_t> actions = {}; // store actions as lambdas to execute in order
         std::atomic<size_t> numPrereqs = 0;
+        std::atomic<size_t> numUnfinishedChildren = 0; // this entry is repacked once its last child finishes
+        std::atomic<bool> queued = false;
         std::atomic<bool> finished = false;
+        std::mutex dataMutex; // children extract from and repack into data, one at a time
     
         friend class RandoSession;
     };
@@ -91,7 +99,12 @@ private:
     std::shared_ptr<CacheEntry> getEntry(const std::vector<std::string>& fileSpec);
     bool extractFile(std::shared_ptr<CacheEntry> current);
     bool repackFile(std::shared_ptr<CacheEntry> current);
+    static std::unique_lock<std::mutex> lockParentData(const std::shared_ptr<CacheEntry>& entry);
+    void queueEntry(std::shared_ptr<CacheEntry> entry);
+    void runNextEntry();
     bool handleChildren(const fspath filename, std::shared_ptr<CacheEntry> current);
+    void finishEntry(std::shared_ptr<CacheEntry> current);
+    void childFinished(std::shared_ptr<CacheEntry> child);
     void clearCache();
     bool runFirstTimeSetup();
 
@@ -99,6 +112,10 @@ private:
     bool initialized = false;
     fspath baseDir;
     fspath outputDir;
+    RepackCache repackCache;
+
+    std::mutex readyMutex;
+    std::vector<std::shared_ptr<CacheEntry>> readyEntries = {}; // entries waiting for a worker, newest first so trees finish before new ones start
     
     std::shared_ptr<CacheEntry> fileCache = std::make_shared<CacheEntry>(nullptr, "", CacheEntry::Format::EMPTY);
 };
@@ -0,0 +1,170 @@
+#include "RepackCache.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <thread>
+#include <vector>
+
+#include <version.hpp>
+#include <libs/hashing.hpp>
+#include <command/Log.hpp>
+
+static constexpr uint32_t REPACK_CACHE_MAGIC = 0x52505743; // "CWPR"
+static constexpr uint32_t REPACK_CACHE_FORMAT = 1;
+
+struct EntryHeader
+{
+    uint32_t magic = REPACK_CACHE_MAGIC;
+    uint32_t format = REPACK_CACHE_FORMAT;
+    uint64_t dataSize = 0;
+};
+
+void RepackCache::init(const fspath& cacheDir, const uintmax_t& maxSize_)
+{
+    dir = cacheDir;
+    maxSize = maxSize_;
+
+    std::error_code ec;
+    std::filesystem::create_directories(dir, ec);
+    enabled = !ec;
+    if (!enabled)
+    {
+        LOG_TO_DEBUG("Could not create repack cache folder, repacking without it");
+    }
+}
+
+std::string RepackCache::getKey(const std::string_view& format, const uint32_t& level, const std::string_view& data) const
+{
+    if (!enabled) return "";
+
+    // Compressor output can change between versions, so they don't share entries
+    SHA1 sha1;
+    const std::string version = RANDOMIZER_VERSION;
+    sha1.add(version.data(), version.size());
+    sha1.add(&REPACK_CACHE_FORMAT, sizeof(REPACK_CACHE_FORMAT));
+    sha1.add(format.data(), format.size());
+    sha1.add(&level, sizeof(level));
+    sha1.add(data.data(), data.size());
+
+    unsigned char hash[SHA1::HashBytes];
+    sha1.getHash(hash);
+
+    static constexpr char digits[] = "0123456789abcdef";
+    std::string key(SHA1::HashBytes * 2, '0');
+    for (size_t i = 0; i < SHA1::HashBytes; i++)
+    {
+        key[i * 2] = digits[hash[i] >> 4];
+        key[i * 2 + 1] = digits[hash[i] & 0xF];
+    }
+    return key;
+}
+
+bool RepackCache::load(const std::string& key, std::string& out) const
+{
+    if (!enabled || key.empty()) return false;
+
+    const fspath entryPath = dir / key;
+    std::ifstream file(entryPath, std::ios::binary);
+    if (!file.is_open()) return false;
+
+    std::error_code ec;
+    const uintmax_t fileSize = std::filesystem::file_size(entryPath, ec);
+    if (ec || fileSize < sizeof(EntryHeader)) return false;
+
+    EntryHeader header;
+    if (!file.read(reinterpret_cast<char*>(&header), sizeof(header))) return false;
+    if (header.magic != REPACK_CACHE_MAGIC || header.format != REPACK_CACHE_FORMAT) return false;
+
+    // Don't trust the header's size until it matches the file, a truncated or corrupted
+    // entry shouldn't be able to make us allocate (or return) anything
+    if (header.dataSize != fileSize - sizeof(EntryHeader)) return false;
+
+    out.resize(header.dataSize);
+    if (!file.read(out.data(), out.size()) || static_cast<uint64_t>(file.gcount()) != header.dataSize)
+    {
+        out.clear();
+        return false;
+    }
+
+    // Anything past the data means the entry wasn't written by us
+    if (file.peek() != std::ifstream::traits_type::eof())
+    {
+        out.clear();
+        return false;
+    }
+
+    // Bump the modified time so prune() treats this as recently used
+    std::filesystem::last_write_time(entryPath, std::filesystem::file_time_type::clock::now(), ec);
+
+    return true;
+}
+
+void RepackCache::store(const std::string& key, const std::string_view& data) const
+{
+    if (!enabled || key.empty()) return;
+
+    // Write to a temporary file first so a partially written entry is never picked up
+    // Other threads may be storing the same data, so give each its own file
+    fspath tempPath = dir / key;
+    tempPath += ".tmp" + std::to_string(std::hash<std::thread::id>{}(std::this_thread::get_id()));
+    {
+        std::ofstream file(tempPath, std::ios::binary);
+        if (!file.is_open()) return;
+
+        EntryHeader header;
+        header.dataSize = data.size();
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.write(data.data(), data.size());
+        if (!file)
+        {
+            file.close();
+            std::error_code ec;
+            std::filesystem::remove(tempPath, ec);
+            return;
+        }
+    }
+
+    std::error_code ec;
+    std::filesystem::rename(tempPath, dir / key, ec);
+    if (ec)
+    {
+        std::filesystem::remove(tempPath, ec);
+    }
+}
+
+void RepackCache::prune() const
+{
+    if (!enabled) return;
+
+    struct Entry {
+        fspath path;
+        uintmax_t size;
+        std::filesystem::file_time_type lastUsed;
+    };
+
+    std::vector<Entry> entries;
+    uintmax_t totalSize = 0;
+    std::error_code ec;
+    for (const auto& dirEntry : std::filesystem::directory_iterator(dir, ec))
+    {
+        if (!dirEntry.is_regular_file(ec)) continue;
+
+        Entry& entry = entries.emplace_back(dirEntry.path(), dirEntry.file_size(ec), dirEntry.last_write_time(ec));
+        totalSize += entry.size;
+    }
+
+    if (totalSize <= maxSize) return;
+
+    std::sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b) { return a.lastUsed < b.lastUsed; });
+    for (const Entry& entry : entries)
+    {
+        if (totalSize <= maxSize) break;
+
+        if (std::filesystem::remove(entry.path, ec))
+        {
+            totalSize -= entry.size;
+        }
+    }
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <cstdint>
+
+#include <utility/path.hpp>
+
+// Compressed copies of files repacked in earlier runs, stored on disk and keyed by a
+// hash of the uncompressed data and how it was compressed. Many files come out the
+// same for every seed patched from the same dump (title screen, fonts, static tweaks),
+// so they can skip recompressing.
+//
+// The key is taken from the modified data rather than the actions that produced it,
+// since actions are arbitrary lambdas and can't be hashed reliably.
+class RepackCache {
+public:
+    void init(const fspath& cacheDir, const uintmax_t& maxSize_);
+    bool isEnabled() const { return enabled; }
+
+    std::string getKey(const std::string_view& format, const uint32_t& level, const std::string_view& data) const;
+    bool load(const std::string& key, std::string& out) const;
+    void store(const std::string& key, const std::string_view& data) const;
+
+    // Remove the least recently used entries until the cache fits in maxSize
+    void prune() const;
+
+private:
+    fspath dir;
+    uintmax_t maxSize = 0;
+    bool enabled = false;
+};
@@ -3,6 +3,7 @@
 #include <sstream>
 
 #include <utility/path.hpp>
+#include <utility/file.hpp>
 
 class FileType {    
     //static_assert(std::is_enum_v<error_enum>, "error_enum must be an enum type");
@@ -18,14 +19,30 @@ protected:
 	virtual void initNew() = 0;
 };
 
+// Unparsed data, kept in a stream so patches can seek around and write over it.
+// The stream's buffer is contiguous, so it can be handed to other formats through
+// data.view() or moved in and out without copying the whole file
 class RawFile final : public FileType {
 public:
     std::stringstream data;
+    Utility::MappedFile source; // Data from the base dump that is only read, used instead of data while it's open
 
     RawFile() = default;
     explicit RawFile(const std::string& data_) :
         data(data_)
     {}
+    explicit RawFile(std::string&& data_) :
+        data(std::move(data_))
+    {}
+
+    // The file's bytes, from the mapping if there is one and the stream if not
+    std::string_view bytes() const { return source.isOpen() ? source.view() : data.view(); }
+
+    // Move the data out without copying it, this leaves the stream empty
+    std::string releaseData() { return std::move(data).str(); }
+
+    // Take over a buffer (like one from writeToBuffer) without copying it
+    void replaceData(std::string&& data_) { data.str(std::move(data_)); }
 private:
     void initNew() override {}
 };
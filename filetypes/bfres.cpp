@@ -355,7 +355,7 @@ namespace FileTypes {
     FRESError resFile::replaceEmbeddedFile(const unsigned int fileIndex, std::stringstream& newFile) {
         const uint32_t originalLen = fresHeader.embeddedFiles[fileIndex].fileLength;
 
-        const std::string& inData = newFile.str();
+        const std::string_view inData = newFile.view();
         fresHeader.embeddedFiles[fileIndex].fileLength = inData.size();
         const int64_t sizeDiff = inData.size() - originalLen;
 
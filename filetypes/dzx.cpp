@@ -201,6 +201,11 @@ namespace FileTypes {
 		return loadFromBinary(file);
 	}
 
+	DZXError DZXFile::loadFromBinary(std::string_view dzx) {
+		Utility::ViewStream in(dzx);
+		return loadFromBinary(in);
+	}
+
 	std::vector<ChunkEntry*> DZXFile::entries_by_type(const std::string& chunk_type) {
 		std::vector<ChunkEntry*> entries;
 		for (Chunk& chunk : chunks) {
@@ -316,4 +321,10 @@ namespace FileTypes {
 		}
 		return writeToStream(outFile);
 	}
+
+	DZXError DZXFile::writeToBuffer(std::string& out) {
+		out.clear();
+		Utility::BufferStream stream(out);
+		return writeToStream(stream);
+	}
 }
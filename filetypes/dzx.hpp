@@ -61,12 +61,14 @@ namespace FileTypes {
         DZXFile() = default;
         static DZXFile createNew();
         DZXError loadFromBinary(std::istream& dzx);
+        DZXError loadFromBinary(std::string_view dzx); // Parses the buffer in place
         DZXError loadFromFile(const fspath& filePath);
         std::vector<ChunkEntry*> entries_by_type(const std::string& chunk_type); // return vector of pointers so we can edit the chunk data
         std::vector<ChunkEntry*> entries_by_type_and_layer(const std::string& chunk_type, unsigned int layer);
         ChunkEntry& add_entity(const std::string&, const unsigned int layer = DEFAULT_LAYER);
         void remove_entity(ChunkEntry* entity);
         DZXError writeToStream(std::ostream& out);
+        DZXError writeToBuffer(std::string& out); // Replaces the contents of out, so it can be moved on without a copy
         DZXError writeToFile(const fspath& outFilePath);
     private:
         void initNew() override;
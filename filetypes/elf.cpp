@@ -201,6 +201,11 @@ namespace FileTypes {
         return loadFromBinary(file);
     }
 
+    ELFError ELF::loadFromBinary(std::string_view elf) {
+        Utility::ViewStream in(elf);
+        return loadFromBinary(in);
+    }
+
     ELFError ELF::extend_section(uint16_t index, const std::string& newData) { // newData is data to append, not replace
         if (isEmpty == true) {
             LOG_ERR_AND_RETURN(ELFError::HEADER_DATA_NOT_LOADED);
@@ -331,4 +336,10 @@ namespace FileTypes {
         }
         return writeToStream(outFile);
     }
+
+    ELFError ELF::writeToBuffer(std::string& out) {
+        out.clear();
+        Utility::BufferStream stream(out);
+        return writeToStream(stream);
+    }
 }
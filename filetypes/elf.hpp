@@ -37,10 +37,12 @@ namespace FileTypes {
         ELF() = default;
         static ELF createNew();
         ELFError loadFromBinary(std::istream& elf);
+        ELFError loadFromBinary(std::string_view elf); // Parses the buffer in place
         ELFError loadFromFile(const fspath& filePath);
         ELFError extend_section(uint16_t index, const std::string& newData);
         ELFError extend_section(uint16_t index, uint32_t startAddr, const std::string& newData);
         ELFError writeToStream(std::ostream& out);
+        ELFError writeToBuffer(std::string& out); // Replaces the contents of out, so it can be moved on without a copy
         ELFError writeToFile(const fspath& outFilePath);
     private:
         bool isEmpty = true;
@@ -4,6 +4,7 @@
 
 #include <utility/endian.hpp>
 #include <utility/common.hpp>
+#include <utility/file.hpp>
 #include <command/Log.hpp>
 
 using eType = Utility::Endian::Type;
@@ -340,6 +341,11 @@ namespace FileTypes {
         return loadFromBinary(file);
     }
 
+    LMSError MSBTFile::loadFromBinary(std::string_view msbt) {
+        Utility::ViewStream in(msbt);
+        return loadFromBinary(in);
+    }
+
     Message& MSBTFile::addMessage(const std::string& label, const Attributes& attributes, const TSY1Entry& style, const std::u16string& message) {
         Message& newMessage = messages_by_label[label];
 
@@ -417,4 +423,10 @@ namespace FileTypes {
         return writeToStream(outFile);
     }
 
+    LMSError MSBTFile::writeToBuffer(std::string& out) {
+        out.clear();
+        Utility::BufferStream stream(out);
+        return writeToStream(stream);
+    }
+
 }
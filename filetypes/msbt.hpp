@@ -110,9 +110,11 @@ namespace FileTypes {
         MSBTFile() = default;
         static MSBTFile createNew();
         LMSError loadFromBinary(std::istream& msbt);
+        LMSError loadFromBinary(std::string_view msbt); // Parses the buffer in place
         LMSError loadFromFile(const fspath& filePath);
         Message& addMessage(const std::string& label, const Attributes& attributes, const TSY1Entry& style, const std::u16string& message);
         LMSError writeToStream(std::ostream& out);
+        LMSError writeToBuffer(std::string& out); // Replaces the contents of out, so it can be moved on without a copy
         LMSError writeToFile(const fspath& outFilePath);
 
     private:
@@ -156,10 +156,7 @@ namespace FileTypes{
         if (nameTable.headerSize_0x8 != 0x8) LOG_ERR_AND_RETURN(SARCError::UNEXPECTED_VALUE);
         if (nameTable.padding_0x00[0] != 0x00 || nameTable.padding_0x00[1] != 0x00) LOG_ERR_AND_RETURN(SARCError::UNEXPECTED_VALUE);
 
-        std::string fileData(header.fileSize - header.dataOffset, '\0'); // TODO: don't do this giant allocation just read each file later?
-        sarc.seekg(header.dataOffset, std::ios::beg);
-        if (!sarc.read(fileData.data(), header.fileSize - header.dataOffset)) LOG_ERR_AND_RETURN(SARCError::REACHED_EOF);
-
+        // Read each file straight into its own string instead of copying all the data out first
         for (const SFATNode& node : fileTable.nodes) {
             if ((node.attributes & 0xFF000000) >> 24 != 0x01) LOG_ERR_AND_RETURN(SARCError::BAD_NODE_ATTR); // TODO: handle hash collisions
 
@@ -169,7 +166,11 @@ namespace FileTypes{
 
             if (calculateHash(name, fileTable.hashKey_0x65) != node.nameHash) LOG_ERR_AND_RETURN(SARCError::FILENAME_HASH_MISMATCH);
 
-            files.emplace(name, fileData.substr(node.dataStart, node.dataEnd - node.dataStart));
+            // Don't trust the node enough to size a buffer from it before checking it fits in the data
+            if (node.dataStart > node.dataEnd || header.dataOffset > header.fileSize || node.dataEnd > header.fileSize - header.dataOffset) LOG_ERR_AND_RETURN(SARCError::UNEXPECTED_VALUE);
+            std::string& fileData = files.emplace(name, std::string(node.dataEnd - node.dataStart, '\0')).first->second;
+            sarc.seekg(header.dataOffset + node.dataStart, std::ios::beg);
+            if (!sarc.read(fileData.data(), fileData.size())) LOG_ERR_AND_RETURN(SARCError::REACHED_EOF);
         }
 
         return SARCError::NONE;
@@ -183,6 +184,11 @@ namespace FileTypes{
         return loadFromBinary(file);
     }
 
+    SARCError SARCFile::loadFromBinary(std::string_view sarc) {
+        Utility::ViewStream in(sarc);
+        return loadFromBinary(in);
+    }
+
     std::string* SARCFile::getFile(const std::string& filename) {
         if (!files.contains(filename)) {
             return nullptr;
@@ -299,6 +305,12 @@ namespace FileTypes{
         return writeToStream(outFile);
     }
 
+    SARCError SARCFile::writeToBuffer(std::string& out) {
+        out.clear();
+        Utility::BufferStream stream(out);
+        return writeToStream(stream);
+    }
+
     SARCError SARCFile::extractToDir(const fspath& dirPath) const {
         for (const auto& [name, data] : files)
         {
@@ -78,9 +78,11 @@ namespace FileTypes {
         SARCFile() = default;
         static SARCFile createNew();
         SARCError loadFromBinary(std::istream& sarc);
+        SARCError loadFromBinary(std::string_view sarc); // Parses the buffer in place
         SARCError loadFromFile(const fspath& filePath);
         std::string* getFile(const std::string& filename);
         SARCError writeToStream(std::ostream& out);
+        SARCError writeToBuffer(std::string& out); // Replaces the contents of out, so it can be moved on without a copy
         SARCError writeToFile(const fspath& outFilePath);
         SARCError extractToDir(const fspath& dirPath) const;
         SARCError replaceFile(const std::string& filename, const fspath& newFilePath);
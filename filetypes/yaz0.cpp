@@ -3,9 +3,14 @@
 #include <string>
 #include <cstring>
 #include <sstream>
+#include <vector>
+#include <algorithm>
+#include <bit>
+#include <thread>
 
 #include <utility/endian.hpp>
 #include <utility/math.hpp>
+#include <utility/thread_local.hpp>
 #include <command/Log.hpp>
 
 struct Yaz0Header 
@@ -16,28 +21,29 @@ struct Yaz0Header
 };
 
 namespace {
-    YAZ0Error readYaz0Header(std::istream& in, Yaz0Header& header)
+    YAZ0Error readYaz0Header(std::span<const char> in, Yaz0Header& header)
     {
-        if(!in.read(header.magic, sizeof(header.magic))) LOG_ERR_AND_RETURN(YAZ0Error::REACHED_EOF);
+        if(in.size() < sizeof(Yaz0Header)) LOG_ERR_AND_RETURN(YAZ0Error::REACHED_EOF);
+        std::memcpy(&header, in.data(), sizeof(Yaz0Header));
         // check magic string in header
         if(std::strncmp(header.magic, "Yaz0", 4) != 0) LOG_ERR_AND_RETURN(YAZ0Error::NOT_YAZ0);
-        if(!in.read(reinterpret_cast<char*>(&header.uncompressedSize), sizeof(header.uncompressedSize))) LOG_ERR_AND_RETURN(YAZ0Error::REACHED_EOF);
         Utility::Endian::toPlatform_inplace(Utility::Endian::Type::Big, header.uncompressedSize);
-        if(!in.read(header._unused0, sizeof(header._unused0))) LOG_ERR_AND_RETURN(YAZ0Error::REACHED_EOF);
         return YAZ0Error::NONE;
     }
-    
-    YAZ0Error yaz0DataDecode(const char* in, char* out, uint32_t outTotalSize)
+
+    YAZ0Error yaz0DataDecode(const char* in, const char* inEnd, char* out, uint32_t outTotalSize)
     {
         uint32_t runLength = 0, runOffset = 0;
         uint8_t codeInfoBlockMSB = 0, codeInfoBlockLSB = 0;
         uint8_t codingModeByte = 0;
         uint8_t validCodingBitCount = 0;
+        char* const firstByte = out;
         char* lastByte = out + outTotalSize;
         while(out < lastByte)
         {
             if(validCodingBitCount == 0)
             {
+                if(in >= inEnd) LOG_ERR_AND_RETURN(YAZ0Error::REACHED_EOF);
                 codingModeByte = *(in++);
                 validCodingBitCount = 8;
             }
@@ -45,6 +51,7 @@ namespace {
             if((codingModeByte & 0x80) == 0)
             {
                 // read two bytes for coding information
+                if(inEnd - in < 2) LOG_ERR_AND_RETURN(YAZ0Error::REACHED_EOF);
                 codeInfoBlockMSB = in[0];
                 codeInfoBlockLSB = in[1];
                 in += 2;
@@ -53,6 +60,7 @@ namespace {
                 // if upper nibble is zero, run length is in (optional) third code info byte
                 if(runLength == 0)
                 {
+                    if(in >= inEnd) LOG_ERR_AND_RETURN(YAZ0Error::REACHED_EOF);
                     runLength = *(reinterpret_cast<const uint8_t*>(in++));
                     runLength += 0x12;
                 }
@@ -60,6 +68,9 @@ namespace {
                 {
                     runLength += 2;
                 }
+                // runs can't reach back before the start or past the end of the output
+                if(static_cast<size_t>(out - firstByte) < runOffset + 1) LOG_ERR_AND_RETURN(YAZ0Error::UNKNOWN);
+                runLength = std::min<uint32_t>(runLength, lastByte - out);
                 char* pRun = out - runOffset - 1;
                 char* pEndRun = pRun + runLength;
                 while(pRun < pEndRun)
@@ -71,6 +82,7 @@ namespace {
             else 
             {
                 // copy single byte and move both pointers forward one
+                if(in >= inEnd) LOG_ERR_AND_RETURN(YAZ0Error::REACHED_EOF);
                 *(out++) = *(in++);
             }
     
@@ -352,6 +364,251 @@ uint32_t Compressor::encode(uint8_t* p_dst, const uint8_t* p_src, uint32_t src_s
 	return out_size;
 }
 
+// Faster hash chain compressor used for compression levels below 9
+// Data is compressed in fixed size chunks so large files can be split between threads.
+// Chunks can still refer back to the end of the previous chunk, so this barely affects
+// the ratio, and the output is the same no matter how many threads are used
+class ChainCompressor {
+public:
+	struct Token {
+		uint16_t len; // 0 for a single copied byte
+		uint16_t value; // the copied byte, or the distance back to the match
+	};
+
+	static constexpr uint32_t cChunkSize = 0x40000;
+
+	static constexpr uint32_t getRequiredMemorySize() {
+		return (cHashNum + cWindowSize) * sizeof(int32_t);
+	}
+
+	static void tokenize(std::vector<Token>& tokens, const uint8_t* p_src, uint32_t src_size, uint32_t start, uint32_t end, uint32_t level, uint8_t* p_work);
+
+	// Packs tokens into groups of 8 behind a flag byte, the same way Compressor::encode does
+	class Writer {
+	public:
+		Writer(uint8_t* p_dst_, uint32_t src_size);
+
+		void write(const Token& token);
+		uint32_t size() const { return out_size; }
+
+	private:
+		uint8_t* p_dst;
+		uint32_t out_size = 0x10; // Header size
+		uint32_t flag_pos = 0;
+		uint32_t count = 0;
+	};
+
+private:
+	enum : uint32_t {
+		cHashBits = 15,
+		cHashNum = 1 << cHashBits,
+		cWindowSize = 0x1000,
+		cWindowMask = cWindowSize - 1,
+		cMinMatch = 3,
+		cMaxMatch = 0x111,
+	};
+
+	struct Params {
+		uint32_t max_chain; // how many earlier positions to check for each match
+		uint32_t nice_len; // stop searching (and skip lazy matching) at this length
+	};
+
+	struct Context {
+		const uint8_t* p_src;
+		uint32_t src_size;
+		uint32_t end;
+		int32_t* p_head;
+		int32_t* p_prev;
+		Params params;
+	};
+
+	struct Match {
+		uint32_t len = 0;
+		uint32_t dist = 0;
+	};
+
+	static Params getParams(uint32_t level);
+	static uint32_t hash(const uint8_t* p);
+	static uint32_t matchLength(const uint8_t* a, const uint8_t* b, uint32_t max_len);
+	static void insert(const Context& context, uint32_t pos);
+	static Match search(const Context& context, uint32_t pos);
+};
+
+ChainCompressor::Params ChainCompressor::getParams(uint32_t level) {
+	static constexpr Params params[] = {
+		{1, 8},
+		{4, 16},
+		{8, 32},
+		{16, 64},
+		{32, 128},
+		{64, 192},
+		{96, cMaxMatch},
+		{128, cMaxMatch},
+		{512, cMaxMatch},
+	};
+
+	return params[std::min<uint32_t>(level, 8)];
+}
+
+uint32_t ChainCompressor::hash(const uint8_t* p) {
+	const uint32_t value = (p[0] << 16) | (p[1] << 8) | p[2];
+	return (value * 0x9E3779B1) >> (32 - cHashBits);
+}
+
+uint32_t ChainCompressor::matchLength(const uint8_t* a, const uint8_t* b, uint32_t max_len) {
+	// Compare 8 bytes at a time, the first differing byte is found from the lowest set bit
+	// (or highest on big endian platforms like the Wii U)
+	uint32_t len = 0;
+	while (len + 8 <= max_len) {
+		uint64_t x, y;
+		memcpy(&x, a + len, 8);
+		memcpy(&y, b + len, 8);
+
+		if (const uint64_t diff = x ^ y; diff != 0) {
+			if constexpr (std::endian::native == std::endian::big) {
+				return len + std::countl_zero(diff) / 8;
+			}
+			else {
+				return len + std::countr_zero(diff) / 8;
+			}
+		}
+		len += 8;
+	}
+
+	while (len < max_len && a[len] == b[len]) len++;
+	return len;
+}
+
+void ChainCompressor::insert(const Context& context, uint32_t pos) {
+	if (pos + cMinMatch > context.src_size) return;
+
+	const uint32_t h = hash(context.p_src + pos);
+	context.p_prev[pos & cWindowMask] = context.p_head[h];
+	context.p_head[h] = pos;
+}
+
+ChainCompressor::Match ChainCompressor::search(const Context& context, uint32_t pos) {
+	Match match;
+
+	const uint32_t max_len = std::min<uint32_t>(cMaxMatch, context.end - pos);
+	if (max_len < cMinMatch) return match;
+
+	const uint32_t stop_len = std::min(context.params.nice_len, max_len);
+	const int64_t min_pos = static_cast<int64_t>(pos) - cWindowSize;
+	const uint8_t* cur = context.p_src + pos;
+
+	// pos hasn't been inserted yet, so every position in the window still has a valid link
+	int32_t cand = context.p_head[hash(cur)];
+	for (uint32_t chain = context.params.max_chain; cand >= min_pos && cand >= 0 && chain > 0; chain--) {
+		const uint8_t* prev = context.p_src + cand;
+
+		// Only a match that beats the current one is useful, check that byte first
+		if (prev[match.len] == cur[match.len]) {
+			const uint32_t len = matchLength(prev, cur, max_len);
+			if (len > match.len) {
+				match.len = len;
+				match.dist = pos - cand;
+
+				if (len >= stop_len) break;
+			}
+		}
+
+		cand = context.p_prev[cand & cWindowMask];
+	}
+
+	if (match.len < cMinMatch) match.len = 0;
+	return match;
+}
+
+void ChainCompressor::tokenize(std::vector<Token>& tokens, const uint8_t* p_src, uint32_t src_size, uint32_t start, uint32_t end, uint32_t level, uint8_t* p_work) {
+	Context context;
+	context.p_src = p_src;
+	context.src_size = src_size;
+	context.end = end;
+	context.p_head = reinterpret_cast<int32_t*>(p_work);
+	context.p_prev = reinterpret_cast<int32_t*>(p_work + cHashNum * sizeof(int32_t));
+	context.params = getParams(level);
+
+	memset(context.p_head, static_cast<uint8_t>(-1), cHashNum * sizeof(int32_t));
+	memset(context.p_prev, static_cast<uint8_t>(-1), cWindowSize * sizeof(int32_t));
+
+	// Fill in the window before the chunk so matches can reach back into it
+	for (uint32_t pos = start > cWindowSize ? start - cWindowSize : 0; pos < start; pos++) {
+		insert(context, pos);
+	}
+
+	tokens.clear();
+
+	// Lazy matching: if the next position has a longer match, copy one byte and use that instead
+	Match next;
+	bool have_next = false;
+	uint32_t pos = start;
+	while (pos < end) {
+		const Match match = have_next ? next : search(context, pos);
+		have_next = false;
+		insert(context, pos);
+
+		if (match.len == 0) {
+			tokens.push_back({0, p_src[pos]});
+			pos++;
+			continue;
+		}
+
+		if (match.len < context.params.nice_len && pos + 1 < end) {
+			next = search(context, pos + 1);
+			if (next.len > match.len) {
+				tokens.push_back({0, p_src[pos]});
+				pos++;
+				have_next = true;
+				continue;
+			}
+		}
+
+		tokens.push_back({static_cast<uint16_t>(match.len), static_cast<uint16_t>(match.dist)});
+		for (uint32_t i = 1; i < match.len; i++) {
+			insert(context, pos + i);
+		}
+		pos += match.len;
+	}
+}
+
+ChainCompressor::Writer::Writer(uint8_t* p_dst_, uint32_t src_size) :
+	p_dst(p_dst_)
+{
+	memcpy(p_dst, "Yaz0", 4);
+	p_dst[4] = (src_size >> 24) & 0xff;
+	p_dst[5] = (src_size >> 16) & 0xff;
+	p_dst[6] = (src_size >> 8) & 0xff;
+	p_dst[7] = (src_size >> 0) & 0xff;
+	memset(p_dst + 8, 0, 8);
+}
+
+void ChainCompressor::Writer::write(const Token& token) {
+	if (count == 0) {
+		flag_pos = out_size++;
+		p_dst[flag_pos] = 0;
+	}
+
+	if (token.len == 0) {
+		p_dst[flag_pos] |= 0x80 >> count;
+		p_dst[out_size++] = static_cast<uint8_t>(token.value);
+	}
+	else {
+		const uint32_t dist = token.value - 1;
+		if (token.len < 18) {
+			p_dst[out_size++] = static_cast<uint8_t>((token.len - 2) << 4) | static_cast<uint8_t>(dist >> 8);
+			p_dst[out_size++] = static_cast<uint8_t>(dist);
+		}
+		else {
+			p_dst[out_size++] = static_cast<uint8_t>(dist >> 8);
+			p_dst[out_size++] = static_cast<uint8_t>(dist);
+			p_dst[out_size++] = static_cast<uint8_t>(token.len - 18);
+		}
+	}
+
+	count = (count + 1) % 8;
+}
+
 namespace FileTypes {
 	const char* YAZ0ErrorGetName(YAZ0Error err) {
 		switch (err) {
@@ -370,19 +627,103 @@ namespace FileTypes {
 		}
 	}
 
-	//TODO: not thread-safe
-	//larger buffer is faster, but too large for stack
-	constexpr uint32_t STATIC_READ_CHUNK_SIZE = 1024 * 1024 * 2;
-	static char readChunkBuf[STATIC_READ_CHUNK_SIZE];
+	// The compressor's work memory is only needed during encoding, so each thread
+	// keeps one around instead of allocating it for every file
+	class CompressorWorkMemory {
+	private:
+		std::vector<uint8_t> memory;
+
+	public:
+		uint8_t* get(const size_t& size) {
+			if (memory.size() < size) memory.resize(size);
+			return memory.data();
+		}
+	};
+	static ThreadLocal<CompressorWorkMemory, DataIDs::YAZ0_WORK_BUFFER> workMemory;
+
+	// Worst case is every byte being copied, plus one flag byte for each 8 bytes (and
+	// the reference compressor always writes a final flag byte)
+	static size_t getMaxEncodedSize(const size_t& size) {
+		return 0x10 + size + roundUp<size_t>(size, 8) / 8 + 1 + 8;
+	}
 
-	YAZ0Error yaz0Decode(std::istream& in, std::ostream& out)
+	YAZ0Error yaz0Decode(std::span<const char> in, std::string& out)
 	{
-		std::string inData{};
-
 		Yaz0Header header{};
 
 		LOG_AND_RETURN_IF_ERR(readYaz0Header(in, header));
 
+		out.resize(header.uncompressedSize);
+		LOG_AND_RETURN_IF_ERR(yaz0DataDecode(in.data() + sizeof(Yaz0Header), in.data() + in.size(), out.data(), header.uncompressedSize));
+
+		return YAZ0Error::NONE;
+	}
+
+	YAZ0Error yaz0Encode(std::span<const char> in, std::string& out, uint32_t compressionLevel, uint32_t numThreads)
+	{
+		out.resize(getMaxEncodedSize(in.size()));
+		uint8_t* const dst = reinterpret_cast<uint8_t*>(out.data());
+		const uint8_t* const src = reinterpret_cast<const uint8_t*>(in.data());
+		const uint32_t srcSize = in.size();
+
+		if (compressionLevel >= 9)
+		{
+			const uint32_t outSize = Compressor::encode(dst, src, srcSize, workMemory.get().get(Compressor::getRequiredMemorySize()));
+			out.resize(outSize);
+
+			return YAZ0Error::NONE;
+		}
+
+		const uint32_t numChunks = (srcSize + ChainCompressor::cChunkSize - 1) / ChainCompressor::cChunkSize;
+		if (numThreads == 0)
+		{
+			numThreads = std::max(std::thread::hardware_concurrency(), 1U);
+		}
+		numThreads = std::clamp(numThreads, 1U, std::max(numChunks, 1U));
+
+		// Chunks are compressed a batch at a time, then written out in order
+		// Only one batch of tokens is kept around to limit memory use
+		std::vector<std::vector<ChainCompressor::Token>> batch(numThreads);
+		std::vector<std::vector<uint8_t>> threadMemory(numThreads - 1, std::vector<uint8_t>(ChainCompressor::getRequiredMemorySize()));
+		uint8_t* const callerMemory = workMemory.get().get(ChainCompressor::getRequiredMemorySize());
+
+		const auto tokenizeChunk = [&](const uint32_t& chunk, std::vector<ChainCompressor::Token>& tokens, uint8_t* work) {
+			const uint32_t start = chunk * ChainCompressor::cChunkSize;
+			const uint32_t end = std::min(srcSize, start + ChainCompressor::cChunkSize);
+			ChainCompressor::tokenize(tokens, src, srcSize, start, end, compressionLevel, work);
+		};
+
+		ChainCompressor::Writer writer(dst, srcSize);
+		for (uint32_t first = 0; first < numChunks; first += numThreads)
+		{
+			const uint32_t batchSize = std::min(numThreads, numChunks - first);
+
+			std::vector<std::thread> threads;
+			for (uint32_t i = 1; i < batchSize; i++)
+			{
+				threads.emplace_back(tokenizeChunk, first + i, std::ref(batch[i]), threadMemory[i - 1].data());
+			}
+			tokenizeChunk(first, batch[0], callerMemory);
+			for (auto& thread : threads)
+			{
+				thread.join();
+			}
+
+			for (uint32_t i = 0; i < batchSize; i++)
+			{
+				for (const auto& token : batch[i])
+				{
+					writer.write(token);
+				}
+			}
+		}
+		out.resize(writer.size());
+
+		return YAZ0Error::NONE;
+	}
+
+	YAZ0Error yaz0Decode(std::istream& in, std::ostream& out)
+	{
 		// IMPROVEMENT: for now we are reading entire file into memory
 		// and allocating a full size output buffer. This can
 		// take up quite a lot of memory, so if it becomes a
@@ -391,39 +732,30 @@ namespace FileTypes {
 		// memory efficient
 
 		// read rest of file into memory
-		while(in.read(readChunkBuf, STATIC_READ_CHUNK_SIZE))
-		{
-			inData.append(readChunkBuf, in.gcount());
-		}
-		inData.append(readChunkBuf, in.gcount());
+		std::stringstream inData;
+		inData << in.rdbuf();
 
-		std::string outData(header.uncompressedSize, '\0'); // string instead of char array to avoid manual deletion
-		LOG_AND_RETURN_IF_ERR(yaz0DataDecode(inData.data(), &outData[0], header.uncompressedSize));
-		out.write(&outData[0], header.uncompressedSize);
+		std::string outData;
+		LOG_AND_RETURN_IF_ERR(yaz0Decode(inData.view(), outData));
+		out.write(outData.data(), outData.size());
 
 		return YAZ0Error::NONE;
 	}
 
 	YAZ0Error yaz0Decode(std::stringstream& in, std::ostream& out)
 	{
-		Yaz0Header header{};
-
-		LOG_AND_RETURN_IF_ERR(readYaz0Header(in, header));
-
-		std::string outData(header.uncompressedSize, '\0'); // string instead of char array to avoid manual deletion
-		LOG_AND_RETURN_IF_ERR(yaz0DataDecode(&in.str()[0x10], &outData[0], header.uncompressedSize));
-		out.write(&outData[0], header.uncompressedSize);
+		std::string outData;
+		LOG_AND_RETURN_IF_ERR(yaz0Decode(in.view(), outData));
+		out.write(outData.data(), outData.size());
 
 		return YAZ0Error::NONE;
 	}
 	
 	YAZ0Error yaz0Encode(const std::stringstream& in, std::ostream& out, uint32_t compressionLevel)
 	{
-		const std::string& inData = in.str();
-    	std::vector<uint8_t> tmp(16 + roundUp<size_t>(inData.size(), 8) / 8 * 9 - 1);
-		std::vector<uint8_t> work(Compressor::getRequiredMemorySize());
-		const uint32_t outSize = Compressor::encode(tmp.data(), reinterpret_cast<const uint8_t*>(inData.data()), inData.size(), work.data());
-		out.write(reinterpret_cast<const char*>(tmp.data()), outSize);
+		std::string outData;
+		LOG_AND_RETURN_IF_ERR(yaz0Encode(in.view(), outData, compressionLevel));
+		out.write(outData.data(), outData.size());
 
 		return YAZ0Error::NONE;
 	}
@@ -5,6 +5,8 @@
 
 #include <cstdint>
 #include <fstream>
+#include <span>
+#include <string>
 
 
 
@@ -25,4 +27,14 @@ namespace FileTypes {
     YAZ0Error yaz0Decode(std::stringstream& in, std::ostream& out);
     //YAZ0Error yaz0Encode(std::istream& in, std::ostream& out, uint32_t compressionLevel = 9);
     YAZ0Error yaz0Encode(const std::stringstream& in, std::ostream& out, uint32_t compressionLevel = 9);
+
+    // Work directly on memory without going through streams
+    // out is resized to fit the data, reusing its existing allocation when it can
+    YAZ0Error yaz0Decode(std::span<const char> in, std::string& out);
+
+    // Level 9 uses the (slow) reference compressor, lower levels use a faster search that
+    // gets faster and slightly worse the lower it goes
+    // Below level 9, large inputs are split into 256KB chunks and compressed on up to
+    // numThreads threads (0 = one per core), the output is the same for any thread count
+    YAZ0Error yaz0Encode(std::span<const char> in, std::string& out, uint32_t compressionLevel = 9, uint32_t numThreads = 1);
 }
@@ -12,6 +12,7 @@ struct EventAccess
 {
     EventId event;
     Requirement requirement;
+    RequirementProgram program;
     Area* area = nullptr;
     World* world = nullptr;
 };
@@ -22,6 +23,7 @@ struct LocationAccess
     Area* area = nullptr;
     Location* location = nullptr;
     Requirement requirement;
+    RequirementProgram program;
 };
 
 class Area
@@ -39,6 +41,8 @@ public:
 
     // variables used for the searching algorithm
     bool isAccessible = false;
+    // position in the world's area table, lets searches keep their own accessible areas
+    int index = -1;
 
     std::string getRegion();
     std::list<std::string> findIslands();
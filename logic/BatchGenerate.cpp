@@ -0,0 +1,81 @@
+
+#include "BatchGenerate.hpp"
+
+#include <thread>
+#include <future>
+#include <algorithm>
+
+#include <libs/BS_thread_pool.hpp>
+
+#include <logic/Generate.hpp>
+#include <logic/Fill.hpp>
+#include <seedgen/random.hpp>
+#include <seedgen/seed.hpp>
+#include <command/Log.hpp>
+
+static BatchResult generateSingle(const Config& config, const size_t& index, const BatchCallback& onGenerated)
+{
+    const auto start = std::chrono::high_resolution_clock::now();
+
+    BatchResult result;
+    ErrorCapture errors;
+
+    // Seeds already run one per thread, so don't split up the fill any further
+    setFillThreadCount(1);
+
+    // Seed this job's RNG the same way as a normal randomization so that
+    // the seed hash and worlds match what a single generation would produce
+    result.permalink = config.getPermalink();
+    const std::string permalink = config.getPermalink(true);
+    if (permalink.empty())
+    {
+        ErrorLog::getInstance().log("Could not generate permalink for RNG seeding.");
+    }
+    else
+    {
+        RandomContext random(seedFromString(permalink));
+        ScopedRandomContext useRandom(random);
+
+        result.seedHash = generate_seed_hash();
+
+        WorldPool worlds(1);
+        std::vector<Settings> settingsVector (1, config.settings);
+        result.returnCode = generateWorlds(worlds, settingsVector, false);
+
+        if (result.returnCode == 0 && onGenerated)
+        {
+            onGenerated(index, worlds);
+        }
+    }
+
+    result.errors = ErrorLog::getInstance().getLastErrors();
+    result.time = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::high_resolution_clock::now() - start);
+    return result;
+}
+
+std::vector<BatchResult> generateBatch(const std::vector<Config>& configs, const size_t& numThreads /*= 0*/, const BatchCallback& onGenerated /*= nullptr*/)
+{
+    size_t threadCount = numThreads;
+    if (threadCount == 0)
+    {
+        threadCount = std::thread::hardware_concurrency() ? std::thread::hardware_concurrency() : 4;
+    }
+    threadCount = std::min(threadCount, std::max<size_t>(configs.size(), 1));
+
+    BS::thread_pool pool(threadCount);
+    std::vector<std::future<BatchResult>> jobs = {};
+    for (size_t i = 0; i < configs.size(); i++)
+    {
+        jobs.push_back(pool.submit([&configs, &onGenerated, i](){
+            return generateSingle(configs[i], i, onGenerated);
+        }));
+    }
+
+    std::vector<BatchResult> results = {};
+    for (auto& job : jobs)
+    {
+        results.push_back(job.get());
+    }
+
+    return results;
+}
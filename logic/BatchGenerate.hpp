@@ -0,0 +1,29 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <chrono>
+#include <functional>
+
+#include <seedgen/config.hpp>
+#include <logic/World.hpp>
+
+// Result of generating a single seed in a batch
+struct BatchResult
+{
+    std::string permalink = "";
+    std::string seedHash = "";
+    int returnCode = 1;
+    std::string errors = "";
+    std::chrono::milliseconds time = std::chrono::milliseconds(0);
+};
+
+// Called on the worker thread once a seed's worlds have been generated successfully.
+// The worlds are destroyed after the callback returns
+using BatchCallback = std::function<void(const size_t& index, WorldPool& worlds)>;
+
+// Generates the worlds for each config on a pool of worker threads. Every seed gets
+// its own worlds, RNG and error log, so each one comes out the same as if it were
+// generated by itself. Results are returned in the same order as the configs.
+// A thread count of 0 uses one thread per hardware thread.
+std::vector<BatchResult> generateBatch(const std::vector<Config>& configs, const size_t& numThreads = 0, const BatchCallback& onGenerated = nullptr);
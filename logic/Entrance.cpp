@@ -16,6 +16,7 @@ Entrance::Entrance(Area* parentArea_, Area* connectedArea_, World* world_) :
     requirement = Requirement();
     requirement.type = RequirementType::NOTHING;
     requirement.args = {};
+    compileRequirement();
 }
 
 Area* Entrance::getParentArea() const
@@ -47,6 +48,11 @@ Area* Entrance::getOriginalConnectedArea() const
     return originalConnectedArea;
 }
 
+void Entrance::setOriginalConnectedArea(Area* newOriginalConnectedArea)
+{
+    originalConnectedArea = newOriginalConnectedArea;
+}
+
 Requirement& Entrance::getRequirement()
 {
     return requirement;
@@ -55,6 +61,17 @@ Requirement& Entrance::getRequirement()
 void Entrance::setRequirement(const Requirement newRequirement)
 {
     requirement = newRequirement;
+    compileRequirement();
+}
+
+const RequirementProgram& Entrance::getRequirementProgram() const
+{
+    return program;
+}
+
+void Entrance::compileRequirement()
+{
+    program.compile(requirement, world);
 }
 
 EntranceType Entrance::getEntranceType() const
@@ -221,6 +238,11 @@ Entrance* Entrance::getAssumed()
     return assumed;
 }
 
+void Entrance::setAssumed(Entrance* assumedEntrance)
+{
+    assumed = assumedEntrance;
+}
+
 bool Entrance::isShuffled() const
 {
     return shuffled;
@@ -246,7 +268,7 @@ void Entrance::setAsDecoupled()
     decoupled = true;
 }
 
-World* Entrance::getWorld()
+World* Entrance::getWorld() const
 {
     return world;
 }
@@ -278,6 +300,16 @@ void Entrance::setFound(const bool& found_)
     found = found_;
 }
 
+int Entrance::getIndex() const
+{
+    return index;
+}
+
+void Entrance::setIndex(const int& index_)
+{
+    index = index_;
+}
+
 bool Entrance::isHidden() const
 {
     return hidden;
@@ -315,9 +347,11 @@ void Entrance::bindTwoWay(Entrance* otherEntrance)
 
 Entrance* Entrance::getNewTarget()
 {
-    auto root = world->getArea("Root");
+    auto root = world->root;
     root->exits.emplace_back(root, connectedArea, world);
     Entrance& targetEntrance = root->exits.back();
+    targetEntrance.setIndex(world->entrancesByIndex.size());
+    world->entrancesByIndex.push_back(&targetEntrance);
     targetEntrance.connect(connectedArea);
     targetEntrance.setReplaces(this);
     return &targetEntrance;
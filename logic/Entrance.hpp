@@ -42,8 +42,11 @@ public:
     Area* getConnectedArea() const;
     void setConnectedArea(Area* newConnectedArea);
     Area* getOriginalConnectedArea() const;
+    void setOriginalConnectedArea(Area* newOriginalConnectedArea);
     Requirement& getRequirement();
     void setRequirement(const Requirement newRequirement);
+    const RequirementProgram& getRequirementProgram() const;
+    void compileRequirement();
     EntranceType getEntranceType() const;
     void setEntranceType(EntranceType newType);
     EntranceType getOriginalEntranceType() const;
@@ -74,12 +77,13 @@ public:
     Entrance* getReplaces();
     void setReplaces(Entrance* replacementEntrance);
     Entrance* getAssumed();
+    void setAssumed(Entrance* assumedEntrance);
     bool isShuffled() const;
     void setAsShuffled();
     void setAsUnshuffled();
     bool isDecoupled() const;
     void setAsDecoupled();
-    World* getWorld();
+    World* getWorld() const;
     void setWorld(World* newWorld);
     Requirement getComputedRequirement() const;
     void setComputedRequirement(const Requirement& req);
@@ -87,6 +91,8 @@ public:
     void setFound(const bool& found_);
     bool isHidden() const;
     void setHidden(const bool& hidden_);
+    int getIndex() const;
+    void setIndex(const int& index_);
 
     std::list<std::string> findIslands();
 
@@ -104,6 +110,7 @@ private:
     Area* connectedArea = nullptr;
     Area* originalConnectedArea = nullptr;
     Requirement requirement;
+    RequirementProgram program;
     EntranceType type = EntranceType::NONE;
     EntranceType originalType = EntranceType::NONE;
     bool primary = false;
@@ -129,6 +136,7 @@ private:
     Requirement computedRequirement;
     bool found = false;
     bool hidden = false;
+    int index = -1; // Unique within the world, removed entrances' indices aren't reused
 };
 
 std::string entranceTypeToName(const EntranceType& type);
@@ -2,11 +2,14 @@
 #include "EntranceShuffle.hpp"
 
 #include <map>
+#include <thread>
 #include <utility>
 
 #include <logic/PoolFunctions.hpp>
 #include <logic/Search.hpp>
 #include <logic/Fill.hpp>
+#include <logic/WorldSnapshot.hpp>
+#include <logic/WorldCopy.hpp>
 #include <utility/file.hpp>
 #include <utility/string.hpp>
 #include <seedgen/random.hpp>
@@ -36,7 +39,7 @@ static void logEntrancePool(EntrancePool& entrancePool, const std::string& poolN
 
 static void logMissingLocations(WorldPool& worlds)
 {
-    static int identifier = 0;
+    static thread_local int identifier = 0;
     LOG_TO_DEBUG("Missing Locations: [");
     for (auto& world : worlds)
     {
@@ -353,9 +356,22 @@ static EntranceShuffleError validateWorld(WorldPool& worlds, const Entrance* ent
     return EntranceShuffleError::NONE;
 }
 
+// The entrances which changeConnections changes the connections of
+static EntrancePool connectionsChangedBy(Entrance* entrance, Entrance* target)
+{
+    EntrancePool changed = {entrance, target};
+    if (entrance->getReverse() && !entrance->isDecoupled())
+    {
+        changed.push_back(target->getReplaces()->getReverse());
+        changed.push_back(entrance->getReverse()->getAssumed());
+    }
+    return changed;
+}
+
 // Attempt to connect the given entrance to the given target and verify that the
-// new world graph is valid for this world's settings
-static EntranceShuffleError replaceEntrance(WorldPool& worlds, Entrance* entrance, Entrance* target, std::vector<EntrancePair>& rollbacks, ItemPool& itemPool)
+// new world graph is valid for this world's settings. beforeReplacement should
+// have the connections of the worlds as they are now, and is kept that way
+static EntranceShuffleError replaceEntrance(WorldPool& worlds, Entrance* entrance, Entrance* target, std::vector<EntrancePair>& rollbacks, ItemPool& itemPool, WorldSnapshot& beforeReplacement)
 {
     LOG_TO_DEBUG("Attempting to Connect " + entrance->getOriginalName() + " To " + target->getReplaces()->getOriginalName());
     ENTRANCE_SHUFFLE_ERROR_CHECK(checkEntrancesCompatibility(entrance, target, rollbacks));
@@ -364,17 +380,115 @@ static EntranceShuffleError replaceEntrance(WorldPool& worlds, Entrance* entranc
     // the attempted connection and try again with a different target.
     if (const EntranceShuffleError err = validateWorld(worlds, entrance, itemPool); err != EntranceShuffleError::NONE)
     {
-        if (entrance->getConnectedArea())
-        {
-            restoreConnections(entrance, target);
-        }
+        LOG_TO_DEBUG("Restoring Connection for " + entrance->getOriginalName());
+        beforeReplacement.restore(worlds);
         return err;
     }
+    beforeReplacement.recordConnections(connectionsChangedBy(entrance, target));
     rollbacks.emplace_back(entrance, target);
     return EntranceShuffleError::NONE;
 }
 
-static EntranceShuffleError shuffleEntrances(WorldPool& worlds, EntrancePool& entrances, EntrancePool& targetEntrances, std::vector<EntrancePair>& rollbacks)
+// A copy of the worlds for trying out replacements on another thread
+struct ScratchWorlds
+{
+    WorldPool worlds = {};
+    WorldSnapshot snapshot = {};
+    WorldSnapshot beforeShuffle = {};
+    ItemPool completeItemPool = {};
+
+    void copy(const WorldPool& originals)
+    {
+        copyWorlds(originals, worlds);
+        beforeShuffle = WorldSnapshot(worlds);
+        snapshot = beforeShuffle;
+        GET_COMPLETE_ITEM_POOL(completeItemPool, worlds)
+    }
+
+    // Undo everything connected since the copy was made, the same as a failed shuffle does to the originals
+    void reset()
+    {
+        beforeShuffle.restore(worlds);
+        snapshot = beforeShuffle;
+    }
+
+    // The copy of the given entrance from the original worlds
+    Entrance* get(const Entrance* original) const
+    {
+        return worlds[original->getWorld()->getWorldId()].entrancesByIndex[original->getIndex()];
+    }
+};
+
+// Does the same as calling replaceEntrance with each target in order until one works,
+// but validates several targets at once. The first thread tries its targets on the worlds
+// themselves and every other thread has its own copy of the worlds. Each attempt is undone
+// from the thread's snapshot, then the first target in order which worked is connected on
+// all of them, so the worlds end up the same as if the targets were tried one at a time
+static EntranceShuffleError replaceEntranceInParallel(WorldPool& worlds, Entrance* entrance, const EntrancePool& targets, std::vector<EntrancePair>& rollbacks, ItemPool& itemPool, WorldSnapshot& snapshot, std::vector<ScratchWorlds>& scratchWorlds)
+{
+    // Skip the same targets trying them one at a time would skip without validating
+    EntrancePool candidates = {};
+    std::vector<EntranceShuffleError> errors = {};
+    for (auto target : targets)
+    {
+        if (target->getConnectedArea() != nullptr)
+        {
+            candidates.push_back(target);
+            errors.push_back(checkEntrancesCompatibility(entrance, target, rollbacks));
+        }
+    }
+
+    const size_t numThreads = scratchWorlds.size() + 1;
+    auto tryTarget = [&](WorldPool& laneWorlds, ItemPool& laneItemPool, const WorldSnapshot& laneSnapshot, Entrance* laneEntrance, Entrance* laneTarget, const size_t& candidate){
+        changeConnections(laneEntrance, laneTarget);
+        errors[candidate] = validateWorld(laneWorlds, laneEntrance, laneItemPool);
+        laneSnapshot.restore(laneWorlds);
+    };
+
+    for (size_t first = 0; first < candidates.size(); first += numThreads)
+    {
+        const size_t last = std::min(first + numThreads, candidates.size());
+        // The lanes already use every thread, so searches within them don't split up any further
+        runOnFillThreads(last - first, [&](const size_t& lane){
+            const size_t candidate = first + lane;
+            if (errors[candidate] != EntranceShuffleError::NONE)
+            {
+                return;
+            }
+            if (lane == 0)
+            {
+                tryTarget(worlds, itemPool, snapshot, entrance, candidates[candidate], candidate);
+                return;
+            }
+            auto& scratch = scratchWorlds[lane - 1];
+            tryTarget(scratch.worlds, scratch.completeItemPool, scratch.snapshot, scratch.get(entrance), scratch.get(candidates[candidate]), candidate);
+        });
+
+        for (size_t candidate = first; candidate < last; candidate++)
+        {
+            Entrance* target = candidates[candidate];
+            LOG_TO_DEBUG("Attempting to Connect " + entrance->getOriginalName() + " To " + target->getReplaces()->getOriginalName() + ": " + errorToName(errors[candidate]));
+            if (errors[candidate] != EntranceShuffleError::NONE)
+            {
+                continue;
+            }
+
+            changeConnections(entrance, target);
+            snapshot.recordConnections(connectionsChangedBy(entrance, target));
+            for (auto& scratch : scratchWorlds)
+            {
+                changeConnections(scratch.get(entrance), scratch.get(target));
+                scratch.snapshot.recordConnections(connectionsChangedBy(scratch.get(entrance), scratch.get(target)));
+            }
+            rollbacks.emplace_back(entrance, target);
+            return EntranceShuffleError::NONE;
+        }
+    }
+
+    return errors.empty() ? EntranceShuffleError::NONE : errors.back();
+}
+
+static EntranceShuffleError shuffleEntrances(WorldPool& worlds, EntrancePool& entrances, EntrancePool& targetEntrances, std::vector<EntrancePair>& rollbacks, std::vector<ScratchWorlds>& scratchWorlds)
 {
 
     ItemPool completeItemPool = {};
@@ -382,6 +496,10 @@ static EntranceShuffleError shuffleEntrances(WorldPool& worlds, EntrancePool& en
 
     shufflePool(entrances);
 
+    // Failed attempts are undone from this. Successful ones are recorded
+    // in it, so it doesn't need to be taken again for each entrance
+    WorldSnapshot beforeEntrance (worlds);
+
     // Place all entrances in the pool, validating worlds after each placement.
     // We first choose a random entrance from the list of entrances and attempt
     // to connect it with random target entrances from the target pool until
@@ -395,17 +513,24 @@ static EntranceShuffleError shuffleEntrances(WorldPool& worlds, EntrancePool& en
         }
         shufflePool(targetEntrances);
 
-        for (auto target : targetEntrances)
+        if (!scratchWorlds.empty())
         {
-            // If the target has already been disconnected, then don't use it again
-            if (target->getConnectedArea() == nullptr)
-            {
-                continue;
-            }
-            err = replaceEntrance(worlds, entrance, target, rollbacks, completeItemPool);
-            if (err == EntranceShuffleError::NONE)
+            err = replaceEntranceInParallel(worlds, entrance, targetEntrances, rollbacks, completeItemPool, beforeEntrance, scratchWorlds);
+        }
+        else
+        {
+            for (auto target : targetEntrances)
             {
-                break;
+                // If the target has already been disconnected, then don't use it again
+                if (target->getConnectedArea() == nullptr)
+                {
+                    continue;
+                }
+                err = replaceEntrance(worlds, entrance, target, rollbacks, completeItemPool, beforeEntrance);
+                if (err == EntranceShuffleError::NONE)
+                {
+                    break;
+                }
             }
         }
 
@@ -435,18 +560,34 @@ static EntranceShuffleError shuffleEntrances(WorldPool& worlds, EntrancePool& en
 // in hopes that a complete failure with valid settings is exceedingly rare.
 static EntranceShuffleError shuffleEntrancePool(World& world, WorldPool& worlds, EntrancePool& entrancePool, EntrancePool& targetEntrances, int retryCount = 20)
 {
+    // Undo failed attempts by putting the worlds back the way they were before any of them
+    const WorldSnapshot beforeShuffle (worlds);
+
+    // Validate several targets at once on copies of the worlds if there are enough of them to
+    // be worth it. The copies are made once for every attempt and put back along with the worlds
+    static constexpr size_t minTargetsPerThread = 4;
+    std::vector<ScratchWorlds> scratchWorlds = {};
+    if (const size_t numThreads = getFillThreadCount(targetEntrances.size() / minTargetsPerThread); numThreads > 1)
+    {
+        scratchWorlds.resize(numThreads - 1);
+        runOnFillThreads(scratchWorlds.size(), [&](const size_t& thread){
+            scratchWorlds[thread].copy(worlds);
+        });
+    }
+
     while (retryCount > 0)
     {
         retryCount--;
         std::vector<EntrancePair> rollbacks = {};
 
-        if (const EntranceShuffleError err = shuffleEntrances(worlds, entrancePool, targetEntrances, rollbacks); err != EntranceShuffleError::NONE)
+        if (const EntranceShuffleError err = shuffleEntrances(worlds, entrancePool, targetEntrances, rollbacks, scratchWorlds); err != EntranceShuffleError::NONE)
         {
             LOG_TO_DEBUG("Failed to place all entrances in a pool for world " + std::to_string(world.getWorldId() + 1) + ". Will retry " + std::to_string(retryCount) + " more times.");
             LOG_TO_DEBUG("Last Error: " + errorToName(err));
-            for (auto& [entrance, target] : rollbacks)
+            beforeShuffle.restore(worlds);
+            for (auto& scratch : scratchWorlds)
             {
-                restoreConnections(entrance, target);
+                scratch.reset();
             }
             continue;
         }
@@ -586,7 +727,8 @@ static EntranceShuffleError setPlandomizerEntrances(World& world, WorldPool& wor
                 if (targetToConnect == targetEntrance->getReplaces())
                 {
                     std::vector<EntrancePair> dummyRollbacks = {};
-                    const EntranceShuffleError err = replaceEntrance(worlds, entranceToConnect, targetEntrance, dummyRollbacks, completeItemPool);
+                    WorldSnapshot beforeReplacement (worlds);
+                    const EntranceShuffleError err = replaceEntrance(worlds, entranceToConnect, targetEntrance, dummyRollbacks, completeItemPool, beforeReplacement);
                     if (err != EntranceShuffleError::NONE)
                     {
                         ErrorLog::getInstance().log("Plandomizer Error when attempting to connect " + fullConnectionName + ": " + errorToName(err));
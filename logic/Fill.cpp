@@ -1,15 +1,23 @@
 #include "Fill.hpp"
 
+#include <atomic>
 #include <chrono>
+#include <functional>
+#include <future>
 #include <numeric>
+#include <optional>
+#include <ranges>
+#include <thread>
 
 #include <logic/Search.hpp>
+#include <logic/IncrementalSearch.hpp>
 #include <logic/PoolFunctions.hpp>
 #include <logic/Dungeon.hpp>
 #include <seedgen/random.hpp>
 #include <command/Log.hpp>
 #include <utility/platform.hpp>
 #include <utility/time.hpp>
+#include <libs/BS_thread_pool.hpp>
 
 #define FILL_ERROR_CHECK(func) if (const FillError err = func; err != FillError::NONE) { return err; }
 
@@ -32,6 +40,84 @@ static void logItemsAndLocations(ItemPool& items, LocationPool& locations)
 
 #define ENOUGH_SPACE_CHECK(items, locations) if (items.size() > locations.size()) {logItemsAndLocations(items, locations);return FillError::MORE_ITEMS_THAN_LOCATIONS;}
 
+static thread_local size_t fillThreadCount = 0;
+
+void setFillThreadCount(const size_t& numThreads)
+{
+    fillThreadCount = numThreads;
+}
+
+// Number of threads to split work between, at most one per job
+size_t getFillThreadCount(const size_t& numJobs)
+{
+    const size_t numThreads = fillThreadCount != 0 ? fillThreadCount : std::max(std::thread::hardware_concurrency(), 1U);
+    return std::max<size_t>(std::min(numThreads, numJobs), 1);
+}
+
+// Made on first use and kept around so splitting up work doesn't start new threads every time.
+// The calling thread always takes a share of the work itself, so it needs one less than that
+static BS::thread_pool& getFillWorkers()
+{
+    #ifdef DEVKITPRO
+        static BS::thread_pool fillWorkers(2);
+    #else
+        static BS::thread_pool fillWorkers(std::max(std::thread::hardware_concurrency(), 2U) - 1);
+    #endif
+
+    return fillWorkers;
+}
+
+namespace
+{
+    // However runOnFillThreads is left, even by an exception, the caller gets its thread
+    // count back and every queued job is done before the job and the caller's stack go away
+    struct FillJobsGuard
+    {
+        const size_t callerThreadCount = fillThreadCount;
+        std::vector<std::future<void>> jobs = {};
+
+        ~FillJobsGuard()
+        {
+            fillThreadCount = callerThreadCount;
+            for (auto& job : jobs)
+            {
+                if (job.valid())
+                {
+                    job.wait();
+                }
+            }
+        }
+    };
+}
+
+void runOnFillThreads(const size_t& numThreads, const std::function<void(const size_t&)>& job)
+{
+    if (numThreads <= 1)
+    {
+        job(0);
+        return;
+    }
+
+    // Jobs never wait on each other, so it's fine if some of them queue up behind the others
+    FillJobsGuard guard;
+    for (size_t thread = 1; thread < numThreads; thread++)
+    {
+        guard.jobs.push_back(getFillWorkers().submit([&job, thread](){
+            setFillThreadCount(1);
+            job(thread);
+        }));
+    }
+
+    fillThreadCount = 1;
+    job(0);
+
+    // Anything a worker's job threw gets thrown again here
+    for (auto& done : guard.jobs)
+    {
+        done.get();
+    }
+}
+
 // Place the given items completely randomly among the given locations.
 static FillError fastFill(ItemPool& items, LocationPool& locations)
 {
@@ -80,15 +166,85 @@ static FillError fillTheRest(ItemPool& items, LocationPool& locations)
     return FillError::NONE;
 }
 
+// Go to the next combination of indices in lexicographic order.
+// Returns false once every combination has been gone through
+static bool nextCombination(std::vector<size_t>& indices, const size_t& numElements)
+{
+    size_t i = indices.size();
+    while (i > 0 && indices[i - 1] == numElements - indices.size() + i - 1)
+    {
+        i--;
+    }
+    if (i == 0)
+    {
+        return false;
+    }
+    indices[i - 1]++;
+    for (; i < indices.size(); i++)
+    {
+        indices[i] = indices[i - 1] + 1;
+    }
+    return true;
+}
+
+// Find the first of the item sets which would let the search reach a new location in allowedLocations.
+// The sets are split between fill threads, each adding and taking back out one set at a time
+// on its own copy of the search (the first thread uses the search itself). Copies are only made
+// the first time they're needed and are kept in setSearches for later batches. Threads stop trying
+// sets once an earlier one has worked, so the result is the same however many threads there are.
+static std::optional<size_t> findUnlockingItemSet(IncrementalSearch& search, std::vector<IncrementalSearch>& setSearches, const std::vector<ItemPool>& itemSets, const LocationMask& allowedLocations)
+{
+    // Too few sets aren't worth handing out to other threads
+    static constexpr size_t minSetsPerThread = 64;
+    const size_t numThreads = getFillThreadCount(itemSets.size() / minSetsPerThread);
+    std::atomic<size_t> firstFound = itemSets.size();
+
+    // Copy the search for the other threads before the first thread starts changing it
+    while (setSearches.size() < numThreads - 1)
+    {
+        setSearches.push_back(search);
+    }
+
+    runOnFillThreads(numThreads, [&](const size_t& first){
+        IncrementalSearch& setSearch = first == 0 ? search : setSearches[first - 1];
+        for (size_t i = first; i < itemSets.size() && i < firstFound; i += numThreads)
+        {
+            for (const auto& item : itemSets[i])
+            {
+                setSearch.addItem(item);
+            }
+            const bool unlocksLocation = !setSearch.getAccessibleLocations(allowedLocations).empty();
+            for (const auto& item : itemSets[i])
+            {
+                setSearch.removeItem(item);
+            }
+
+            if (unlocksLocation)
+            {
+                size_t found = firstFound;
+                while (i < found && !firstFound.compare_exchange_weak(found, i));
+                break;
+            }
+        }
+    });
+
+    if (firstFound == itemSets.size())
+    {
+        return std::nullopt;
+    }
+    return firstFound;
+}
+
 // Sometimes assumed fill will fail a lot if there's only one or two initial locations open.
 // In this case we'll switch to forward fill for some time until there are more free places to
-// place items. The 3rd parameter allowedLocations is a copy of the passed in LocationPool since
-// we want to locally modify it in this function, but not outside of it
-FillError forwardFillUntilMoreFreeSpace(WorldPool& worlds, ItemPool& itemsToPlace, LocationPool allowedLocations, size_t openLocations /*= 3*/)
+// place items.
+FillError forwardFillUntilMoreFreeSpace(WorldPool& worlds, ItemPool& itemsToPlace, const LocationPool& allowedLocations, size_t openLocations /*= 3*/)
 {
     ItemPool forwardPlacedItems;
     ItemPool noItems;
-    auto accessibleLocations = getAccessibleLocations(worlds, forwardPlacedItems, allowedLocations);
+    // Locally track which allowed locations haven't been opened up yet
+    LocationMask allowedMask (allowedLocations);
+    auto accessibleLocations = getAccessibleLocations(worlds, noItems, allowedMask);
 
     if (accessibleLocations.empty())
     {
@@ -101,6 +257,18 @@ FillError forwardFillUntilMoreFreeSpace(WorldPool& worlds, ItemPool& itemsToPlac
         return FillError::NONE;
     }
 
+    // Items are only ever placed at reachable locations, so from here on one search
+    // can keep growing instead of searching the worlds again every time. Nothing
+    // after forward fill needs its results on the worlds
+    IncrementalSearch search (worlds);
+    search.detach();
+    // Copies of the search for other threads to try item sets on, kept up to date along with it
+    std::vector<IncrementalSearch> setSearches = {};
+
+    // Sets of items are tried in batches so we can stop early without
+    // putting together every set first
+    static constexpr size_t setsPerBatch = 1024;
+
     bool successfullyPlacedItems = false;
     LOG_TO_DEBUG("Number of open locations: " + std::to_string(accessibleLocations.size()));
     while (accessibleLocations.size() < openLocations * worlds.size() || !successfullyPlacedItems)
@@ -113,75 +281,107 @@ FillError forwardFillUntilMoreFreeSpace(WorldPool& worlds, ItemPool& itemsToPlac
             }
         #endif
         // Filter out already accessible locations
-        filterAndEraseFromPool(allowedLocations, [accessibleLocations](const Location* loc){return elementInPool(loc, accessibleLocations);});
+        for (const auto location : accessibleLocations)
+        {
+            allowedMask.remove(location);
+        }
         shufflePool(itemsToPlace);
 
-        auto sizeBefore = forwardPlacedItems.size();
+        // Only items which something unreached still checks for can help. Put copies
+        // of the same item next to each other so sets which only differ by which copy
+        // they use can be skipped
+        std::vector<size_t> candidates = {};
+        std::vector<char> onFrontier = {};
+        std::vector<char> sameAsPrevious = {};
+        for (size_t i = 0; i < itemsToPlace.size(); i++)
+        {
+            const Item& item = itemsToPlace[i];
+            if (!search.itemStillNeeded(item) || std::ranges::any_of(candidates, [&](const size_t& c){return itemsToPlace[c] == item;}))
+            {
+                continue;
+            }
+            for (size_t j = i; j < itemsToPlace.size(); j++)
+            {
+                if (itemsToPlace[j] == item)
+                {
+                    sameAsPrevious.push_back(j != i);
+                    candidates.push_back(j);
+                    onFrontier.push_back(search.itemOnFrontier(item));
+                }
+            }
+        }
 
         // The idea here is to try every combination of 1..n items where n is the number of available
         // places to place items. First try all items individually, then every set of 2, then 3, etc.
-        // until we find a combination of items that opens up more space
-        for (size_t itemsInSet = 1; itemsInSet <= accessibleLocations.size(); itemsInSet++)
+        // until we find a combination of items that opens up more space. A set can only open up
+        // something new if at least one of its items is checked for right outside what's reachable,
+        // and it only needs trying once for each distinct group of items.
+        ItemPool newForwardItems = {};
+        for (size_t itemsInSet = 1; itemsInSet <= std::min(accessibleLocations.size(), candidates.size()) && !successfullyPlacedItems; itemsInSet++)
         {
             std::vector<size_t> indices (itemsInSet, 0);
             std::iota(indices.begin(), indices.end(), 0);
 
-            do
+            bool moreSets = true;
+            while (moreSets && !successfullyPlacedItems)
             {
-                // increment the indices, starting with an attempt at the last one
-                // and moving back to increment previous indices if necessary.
-                for (size_t i = indices.size() - 1; i >= 0; i--) // loop is infinite due to uints
+                std::vector<ItemPool> itemSets = {};
+                for (; moreSets && itemSets.size() < setsPerBatch; moreSets = nextCombination(indices, candidates.size()))
                 {
-                    size_t max = itemsToPlace.size() - (indices.size() - i);
-
-                    if (indices[i] < max)
+                    const bool firstCopies = std::ranges::all_of(std::views::iota(size_t(0), itemsInSet), [&](const size_t& i){
+                        return !sameAsPrevious[indices[i]] || (i > 0 && indices[i - 1] == indices[i] - 1);
+                    });
+                    const bool anyOnFrontier = std::ranges::any_of(indices, [&](const size_t& index){return onFrontier[index];});
+                    if (!firstCopies || !anyOnFrontier)
                     {
-                        size_t counter = 1;
-                        for (; i < indices.size(); i++)
-                        {
-                            indices[i] += counter++;
-                        }
-                        break;
+                        continue;
                     }
-                    else
+
+                    auto& itemSet = itemSets.emplace_back();
+                    for (const auto& index : indices)
                     {
-                        indices[i] = indices[i-1];
+                        itemSet.push_back(itemsToPlace[candidates[index]]);
                     }
                 }
 
-                ItemPool newForwardItems = {};
-                LOG_TO_DEBUG("Trying forward items: ");
-                for (auto& index : indices)
+                if (const auto found = findUnlockingItemSet(search, setSearches, itemSets, allowedMask); found.has_value())
                 {
-                    newForwardItems.push_back(itemsToPlace[index]);
-                    LOG_TO_DEBUG("\t" + itemsToPlace[index].getName());
-                }
-
-
-                if (!getAccessibleLocations(worlds, newForwardItems, allowedLocations).empty())
-                {
-                    addElementsToPool(forwardPlacedItems, newForwardItems);
-                    fastFill(newForwardItems, accessibleLocations);
+                    newForwardItems = itemSets[found.value()];
                     successfullyPlacedItems = true;
-                    break;
                 }
-
-            } while (indices[0] < itemsToPlace.size() - itemsInSet);
-
-            if (successfullyPlacedItems)
-            {
-                break;
             }
         }
 
         // If no new items were placed, then we can't progress
-        if (forwardPlacedItems.size() == sizeBefore)
+        if (!successfullyPlacedItems)
         {
             LOG_TO_DEBUG("No item combinations opened up progression during forward fill attempt");
             return FillError::RAN_OUT_OF_RETRIES;
         }
-        sizeBefore = forwardPlacedItems.size();
-        accessibleLocations = getAccessibleLocations(worlds, noItems, allowedLocations);
+
+        LOG_TO_DEBUG("Placing forward items: ");
+        #ifdef ENABLE_DEBUG
+            for (const auto& item : newForwardItems)
+            {
+                LOG_TO_DEBUG("\t" + item.getName());
+            }
+        #endif
+        addElementsToPool(forwardPlacedItems, newForwardItems);
+        const LocationPool openedLocations = accessibleLocations;
+        fastFill(newForwardItems, accessibleLocations);
+        for (const auto location : openedLocations)
+        {
+            search.updateLocation(location);
+            for (auto& setSearch : setSearches)
+            {
+                setSearch.updateLocation(location);
+            }
+        }
+
+        // Trying item sets changes the order the search reached things in, so sort
+        // the locations to keep placements the same however many threads tried them
+        accessibleLocations = search.getAccessibleLocations(allowedMask);
+        std::ranges::sort(accessibleLocations, PointerLess<Location>());
         LOG_TO_DEBUG("Number of open locations: " + std::to_string(accessibleLocations.size()));
     }
 
@@ -195,11 +395,22 @@ FillError forwardFillUntilMoreFreeSpace(WorldPool& worlds, ItemPool& itemsToPlac
 }
 
 // Place the given items within the given locations using the assumed fill algorithm. If a world to fill is specified
-// then only that world's graph will be explored to find accessible locations
+// then only that world's graph will be explored to find accessible locations.
+// One search is kept for the whole fill: it starts out assuming every item which isn't placed yet, and each
+// placement takes that item out of the assumed items and puts it at its location instead. The search only
+// has to redo the parts which depended on the item instead of starting over for every placement.
 static FillError assumedFill(WorldPool& worlds, ItemPool& itemsToPlace, const ItemPool& itemsNotYetPlaced, LocationPool& allowedLocations, int worldToFill = -1)
 {
     ENOUGH_SPACE_CHECK(itemsToPlace, allowedLocations);
 
+    auto makeSearch = [&](){
+        ItemPool assumedItems (itemsNotYetPlaced);
+        addElementsToPool(assumedItems, itemsToPlace);
+        return IncrementalSearch(worlds, assumedItems, worldToFill);
+    };
+
+    const LocationMask allowedMask (allowedLocations);
+    IncrementalSearch search = makeSearch();
     int retries = 5;
     bool unsuccessfulPlacement = false;
     do
@@ -213,6 +424,8 @@ static FillError assumedFill(WorldPool& worlds, ItemPool& itemsToPlace, const It
             }
             else
             {
+                // Forward fill placed some of the items and searched the worlds itself
+                search = makeSearch();
                 retries = 5;
                 continue;
             }
@@ -229,11 +442,10 @@ static FillError assumedFill(WorldPool& worlds, ItemPool& itemsToPlace, const It
 
             // Assume we have all items which haven't been placed yet
             // (except for the one we're about to place).
-            ItemPool assumedItems (itemsNotYetPlaced);
-            addElementsToPool(assumedItems, itemsToPlace);
+            search.removeItem(item);
 
             // Get a list of accessible locations
-            auto accessibleLocations = getAccessibleLocations(worlds, assumedItems, allowedLocations, worldToFill);
+            auto accessibleLocations = search.getAccessibleLocations(allowedMask);
 
             // If there aren't any accessible locations, rollback any previously
             // used locations in this group and add their items back to the
@@ -245,10 +457,13 @@ static FillError assumedFill(WorldPool& worlds, ItemPool& itemsToPlace, const It
                 {
                     LOG_TO_DEBUG("Rolling back " + location->getName() + ": " + location->currentItem.getName());
                     itemsToPlace.push_back(location->currentItem);
+                    search.addItem(location->currentItem);
                     location->currentItem = Item(GameItem::INVALID, nullptr);
+                    search.updateLocation(location);
                 }
                 // Also add back the randomly selected item
                 itemsToPlace.push_back(item);
+                search.addItem(item);
                 rollbacks.clear();
                 // Break out of the item placement loop and flag an unsuccessful
                 // placement attempt to try again.
@@ -272,6 +487,7 @@ static FillError assumedFill(WorldPool& worlds, ItemPool& itemsToPlace, const It
             // location to the list of rollbacks
             auto location = RandomElement(accessibleLocations);
             location->currentItem = item;
+            search.updateLocation(location);
             rollbacks.push_back(location);
             LOG_TO_DEBUG("Placed " + item.getName() + " at " + location->getName());
         }
@@ -321,6 +537,43 @@ void placeVanillaItems(WorldPool& worlds)
     }
 }
 
+// Check which items can't be taken out of the search without making some of the
+// progression locations unreachable. Every item is checked separately on a copy of
+// the search split between numThreads fill threads, so nothing shared is changed.
+static std::vector<char> findAlwaysRequiredItems(const IncrementalSearch& search, const std::vector<Item*>& items, const std::unordered_map<Item*, Location*>& itemLocations, const LocationPool& progressionLocations, const size_t& numThreads)
+{
+    std::vector<char> required (items.size(), false);
+
+    auto checkItems = [&](const size_t& first){
+        IncrementalSearch itemSearch = search;
+        itemSearch.detach();
+        for (size_t i = first; i < items.size(); i += numThreads)
+        {
+            const Item& item = *items[i];
+            if (item.isJunkItem())
+            {
+                continue;
+            }
+
+            if (const auto& location = itemLocations.find(items[i]); location != itemLocations.end())
+            {
+                itemSearch.ignoreLocationItem(location->second);
+                required[i] = !itemSearch.locationsReachable(progressionLocations);
+                itemSearch.ignoreLocationItem(location->second, false);
+            }
+            else
+            {
+                itemSearch.removeItem(item);
+                required[i] = !itemSearch.locationsReachable(progressionLocations);
+                itemSearch.addItem(item);
+            }
+        }
+    };
+
+    runOnFillThreads(numThreads, checkItems);
+    return required;
+}
+
 // Determine which items are major items. A major item is any item required
 // for access to any progression location and/or game beatability. This function
 // is called multiple times during the fill algorithm as the items required for
@@ -331,8 +584,10 @@ void determineMajorItems(WorldPool& worlds, ItemPool& itemPool, LocationPool& al
     LOG_TO_DEBUG("New Major Items: [");
     auto progressionLocations = filterFromPool(allLocations, [](const Location* location){return location->progression;});
 
-    // Combine the item pool as well as all items that have already been placed to test
+    // Combine the item pool as well as all items that have already been placed to test.
+    // Remember which location each placed item is at so the search can be updated
     std::vector<Item*> totalItemPool = {};
+    std::unordered_map<Item*, Location*> itemLocations = {};
     for (auto& item : itemPool)
     {
         totalItemPool.push_back(&item);
@@ -344,27 +599,64 @@ void determineMajorItems(WorldPool& worlds, ItemPool& itemPool, LocationPool& al
             if (location->currentItem.getGameItemId() != GameItem::INVALID)
             {
                 totalItemPool.push_back(&location->currentItem);
+                itemLocations[&location->currentItem] = location;
             }
         }
     }
 
+    // Each item only changes the search by a single item, so keep the same
+    // search between them instead of starting over every time
+    IncrementalSearch itemSearch (worlds, itemPool);
+    auto setItemId = [&](Item* item, const GameItem& gameItemId){
+        if (itemLocations.contains(item))
+        {
+            item->setGameItemId(gameItemId);
+            itemSearch.updateLocation(itemLocations[item]);
+        }
+        else
+        {
+            itemSearch.removeItem(*item);
+            item->setGameItemId(gameItemId);
+            itemSearch.addItem(*item);
+        }
+    };
+
     shufflePool(totalItemPool);
-    for (auto item : totalItemPool)
+
+    // Removing items only makes things harder to reach, so an item which is required
+    // with every other item available stays required however many others are taken
+    // out before it. Checking those up front on other threads leaves the same result
+    // as the loop below, which then only has to go through the rest one at a time.
+    // On a single thread this would just be extra searching, so skip it there
+    const size_t numThreads = getFillThreadCount(totalItemPool.size());
+    std::vector<char> alwaysRequired (totalItemPool.size(), false);
+    if (numThreads > 1)
     {
+        alwaysRequired = findAlwaysRequiredItems(itemSearch, totalItemPool, itemLocations, progressionLocations, numThreads);
+    }
+
+    for (size_t i = 0; i < totalItemPool.size(); i++)
+    {
+        Item* item = totalItemPool[i];
+        if (alwaysRequired[i])
+        {
+            item->setAsMajorItem();
+            LOG_TO_DEBUG("\t" + item->getName());
+        }
         // Don't check junk items
-        if (!item->isJunkItem())
+        else if (!item->isJunkItem())
         {
             // Temporarily take this item out of the pool
             const auto gameItemId = item->getGameItemId();
-            item->setGameItemId(GameItem::NOTHING);
+            setItemId(item, GameItem::NOTHING);
 
             // If all progress locations are not reachable,
             // set it as a major item and give back it's gameitemId
             
-            if (!locationsReachable(worlds, itemPool, progressionLocations))
+            if (!itemSearch.locationsReachable(progressionLocations))
             {
                 item->setAsMajorItem();
-                item->setGameItemId(gameItemId);
+                setItemId(item, gameItemId);
                 LOG_TO_DEBUG("\t" + item->getName());
             }
             // Otherwise save the gameItemId to re-apply later once all major items
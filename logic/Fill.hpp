@@ -1,6 +1,8 @@
 
 #pragma once
 
+#include <functional>
+
 #include <logic/World.hpp>
 
 enum struct FillError
@@ -15,9 +17,15 @@ enum struct FillError
 };
 
 void placeVanillaItems(WorldPool& worlds);
-FillError forwardFillUntilMoreFreeSpace(WorldPool& worlds, ItemPool& itemsToPlace, LocationPool allowedLocations, size_t openLocations = 3);
+FillError forwardFillUntilMoreFreeSpace(WorldPool& worlds, ItemPool& itemsToPlace, const LocationPool& allowedLocations, size_t openLocations = 3);
 FillError validateEnoughLocations(WorldPool& worlds);
 void determineMajorItems(WorldPool& worlds, ItemPool& itemPool, LocationPool& allLocations);
+// Number of threads fill and entrance shuffling split work between for the calling thread (0 = one per core)
+void setFillThreadCount(const size_t& numThreads);
+size_t getFillThreadCount(const size_t& numJobs);
+// Run job(thread) for each thread from 0 to numThreads - 1 and wait for all of them. The calling thread
+// does thread 0 and the others use workers kept between calls. Jobs see a fill thread count of 1
+void runOnFillThreads(const size_t& numThreads, const std::function<void(const size_t& thread)>& job);
 FillError fill(std::vector<World>& worlds);
 void clearWorlds(WorldPool& worlds);
 std::string errorToName(FillError err);
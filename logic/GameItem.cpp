@@ -806,6 +806,11 @@ World* Item::getWorld() const
     return world;
 }
 
+void Item::setWorld(World* newWorld)
+{
+    world = newWorld;
+}
+
 int Item::getWorldId() const
 {
     return world->getWorldId();
@@ -884,7 +889,12 @@ void Item::addChainLocation(Location* location)
     chainLocations.insert(location);
 }
 
-std::unordered_set<Location*> Item::getChainLocations() const
+void Item::setChainLocations(const std::unordered_set<Location*>& newChainLocations)
+{
+    chainLocations = newChainLocations;
+}
+
+const std::unordered_set<Location*>& Item::getChainLocations() const
 {
     return chainLocations;
 }
@@ -421,6 +421,7 @@ public:
     Item(std::string itemName_, World* world_);
 
     World* getWorld() const;
+    void setWorld(World* newWorld);
     int getWorldId() const;
     void setGameItemId(GameItem newGameItemId);
     GameItem getGameItemId() const;
@@ -430,7 +431,8 @@ public:
     bool isMajorItem() const;
     bool isChartForSunkenTreasure() const;
     void addChainLocation(Location* location);
-    std::unordered_set<Location*> getChainLocations() const;
+    void setChainLocations(const std::unordered_set<Location*>& newChainLocations);
+    const std::unordered_set<Location*>& getChainLocations() const;
     std::string getName() const;
     std::string getUTF8Name(const std::string& language = "English", const Text::Type& type = Text::Type::STANDARD, const Text::Color& color = Text::Color::RAW, const bool& showWorld = false) const;
     std::u16string getUTF16Name(const std::string& language = "English", const Text::Type& type = Text::Type::STANDARD, const Text::Color& color = Text::Color::RED, const bool& showWorld = false) const;
@@ -5,6 +5,7 @@
 
 #include <logic/Plandomizer.hpp>
 #include <logic/World.hpp>
+#include <logic/WorldTemplate.hpp>
 #include <logic/Fill.hpp>
 #include <logic/Search.hpp>
 #include <logic/SpoilerLog.hpp>
@@ -20,7 +21,7 @@
 
 #define WORLD_LOADING_ERROR_CHECK(err) if (err != World::WorldLoadingError::NONE) {ErrorLog::getInstance().log(world.getLastErrorDetails()); return 1;}
 
-int generateWorlds(WorldPool& worlds, std::vector<Settings>& settingsVector)
+int generateWorlds(WorldPool& worlds, std::vector<Settings>& settingsVector, const bool& showProgress /*= true*/)
 {
   #ifdef ENABLE_TIMING
       ScopedTimer<"Building and Filling took ", std::chrono::milliseconds> timer;
@@ -28,9 +29,19 @@ int generateWorlds(WorldPool& worlds, std::vector<Settings>& settingsVector)
   // Build worlds on a per-world basis incase we ever support different world graphs
   // per player
   #ifndef LOGIC_TESTS
-      Utility::platformLog(std::string("Building World") + (worlds.size() > 1 ? "s" : ""));
-      UPDATE_DIALOG_LABEL("Building World");
+      if (showProgress)
+      {
+          Utility::platformLog(std::string("Building World") + (worlds.size() > 1 ? "s" : ""));
+          UPDATE_DIALOG_LABEL("Building World");
+      }
   #endif
+  // Parse the logic files once for every world and retry
+  const auto worldTemplate = WorldTemplate::getDefault();
+  if (worldTemplate == nullptr)
+  {
+      return 1;
+  }
+
   int buildRetryCount = 20;
   int fillAttemptCount = 0;
   while (buildRetryCount > 0)
@@ -75,7 +86,7 @@ int generateWorlds(WorldPool& worlds, std::vector<Settings>& settingsVector)
       for (auto& world : worlds)
       {
           world.resolveRandomSettings();
-          if (world.loadWorld(Utility::get_data_path() / "logic/world.yaml", Utility::get_data_path() / "logic/macros.yaml", Utility::get_data_path() / "logic/location_data.yaml", Utility::get_data_path() / "logic/item_data.yaml", Utility::get_data_path() / "logic/area_names.yaml"))
+          if (world.loadWorld(*worldTemplate))
           {
               return 1;
           }
@@ -170,9 +181,12 @@ int generateWorlds(WorldPool& worlds, std::vector<Settings>& settingsVector)
       FillError fillError = FillError::NONE;
       #ifndef LOGIC_TESTS
           const std::string message = std::string("Filling World") + (worlds.size() > 1 ? "s" : "") + (fillAttemptCount++ > 0 ? " (Attempt " + std::to_string(fillAttemptCount) + ")" : "");
-          Utility::platformLog(message);
-          UPDATE_DIALOG_VALUE(10);
-          UPDATE_DIALOG_LABEL(message.c_str());
+          if (showProgress)
+          {
+              Utility::platformLog(message);
+              UPDATE_DIALOG_VALUE(10);
+              UPDATE_DIALOG_LABEL(message.c_str());
+          }
       #endif
       while (totalFillAttempts > 0)
       {
@@ -211,16 +225,22 @@ int generateWorlds(WorldPool& worlds, std::vector<Settings>& settingsVector)
   }
 
   #ifndef LOGIC_TESTS
-      Utility::platformLog("Generating Playthrough");
-      UPDATE_DIALOG_VALUE(15);
-      UPDATE_DIALOG_LABEL("Generating Playthrough");
+      if (showProgress)
+      {
+          Utility::platformLog("Generating Playthrough");
+          UPDATE_DIALOG_VALUE(15);
+          UPDATE_DIALOG_LABEL("Generating Playthrough");
+      }
   #endif
   generatePlaythrough(worlds);
 
   #ifndef LOGIC_TESTS
-      Utility::platformLog("Generating Hints");
-      UPDATE_DIALOG_VALUE(20);
-      UPDATE_DIALOG_LABEL("Generating Hints");
+      if (showProgress)
+      {
+          Utility::platformLog("Generating Hints");
+          UPDATE_DIALOG_VALUE(20);
+          UPDATE_DIALOG_LABEL("Generating Hints");
+      }
   #endif
   if (const HintError err = generateHints(worlds); err != HintError::NONE)
   {
@@ -5,4 +5,6 @@
 #include <options.hpp>
 #include <logic/World.hpp>
 
-int generateWorlds(WorldPool& worlds, std::vector<Settings>& settingsVector);
+// Progress messages can be turned off for generations running in the background,
+// such as batch generation
+int generateWorlds(WorldPool& worlds, std::vector<Settings>& settingsVector, const bool& showProgress = true);
@@ -1,7 +1,11 @@
 #include "Hints.hpp"
 
+#include <functional>
+
 #include <logic/Search.hpp>
+#include <logic/IncrementalSearch.hpp>
 #include <logic/PoolFunctions.hpp>
+#include <logic/Fill.hpp>
 #include <seedgen/random.hpp>
 #include <command/Log.hpp>
 #include <filetypes/util/msbtMacros.hpp>
@@ -51,40 +55,62 @@ static HintError calculatePossiblePathLocations(WorldPool& worlds)
     }
 
     // Determine path locations for each goal location by going through the playthrough
-    // and seeing if taking away the item at each location can still access the goal locations
+    // and seeing if taking away the item at each location can still access the goal locations.
+    // Each location is its own job, searching as if that location had no item. The jobs
+    // are split between threads, each ignoring one location's item at a time on its own
+    // copy of the search, so nothing on the worlds changes while they run
+    std::vector<Location*> potentialPathLocations = {};
+    std::vector<LocationPool> progressionLocations = {};
     for (auto& world : worlds)
     {
-        for (auto& potentialPathLocation : world.getProgressionLocations())
+        for (auto& potentialPathLocation : progressionLocations.emplace_back(world.getProgressionLocations()))
         {
-            const Item itemAtLocation = potentialPathLocation->currentItem;
-            if (itemAtLocation.isJunkItem())
+            if (!potentialPathLocation->currentItem.isJunkItem())
             {
-                continue;
+                potentialPathLocations.push_back(potentialPathLocation);
             }
+        }
+    }
 
-            // Take the item away from the location
-            potentialPathLocation->currentItem = Item(GameItem::INVALID, potentialPathLocation->world);
-
-            // Run a search without the item
-            runGeneralSearch(worlds);
-
-            for (auto& location : world.getProgressionLocations())
+    // Locations in the same world which can't be reached without each job's location's item
+    std::vector<LocationPool> unreachedLocations (potentialPathLocations.size());
+    IncrementalSearch pathSearch (worlds);
+    pathSearch.detach();
+    const size_t numThreads = getFillThreadCount(potentialPathLocations.size());
+    std::vector<IncrementalSearch> jobSearches (numThreads - 1, pathSearch);
+    runOnFillThreads(numThreads, [&](const size_t& first){
+        IncrementalSearch& jobSearch = first == 0 ? pathSearch : jobSearches[first - 1];
+        for (size_t i = first; i < potentialPathLocations.size(); i += numThreads)
+        {
+            Location* potentialPathLocation = potentialPathLocations[i];
+            jobSearch.ignoreLocationItem(potentialPathLocation);
+            for (auto& location : progressionLocations[potentialPathLocation->world->getWorldId()])
             {
                 // If we never reached the goal location, then this location
                 // is "on the path to" the goal location. Since hints will refer
                 // to locations in an individual's world, only add locations
                 // which are in the same world as the goal location
-                if (!location->hasBeenFound)
+                if (!jobSearch.locationReachable(location))
                 {
-                    location->pathLocations.push_back(potentialPathLocation);
+                    unreachedLocations[i].push_back(location);
                 }
             }
+            jobSearch.ignoreLocationItem(potentialPathLocation, false);
+        }
+    });
 
-            // Then give back the location's item
-            potentialPathLocation->currentItem = itemAtLocation;
+    // Add path locations in the same order as going through the jobs one at a time
+    for (size_t i = 0; i < potentialPathLocations.size(); i++)
+    {
+        for (auto location : unreachedLocations[i])
+        {
+            location->pathLocations.push_back(potentialPathLocations[i]);
         }
+    }
 
-        #ifdef ENABLE_DEBUG
+    #ifdef ENABLE_DEBUG
+        for (auto& world : worlds)
+        {
             for (auto& location : world.getProgressionLocations())
             {
                 LOG_TO_DEBUG("Path locations for " + location->getName() + " [");
@@ -94,8 +120,8 @@ static HintError calculatePossiblePathLocations(WorldPool& worlds)
                 }
                 LOG_TO_DEBUG("]");
             }
-        #endif
-    }
+        }
+    #endif
 
     // Give back nonprogress location items
     for (auto& [location, item] : nonRequiredLocations)
@@ -106,15 +132,107 @@ static HintError calculatePossiblePathLocations(WorldPool& worlds)
     return HintError::NONE;
 }
 
+// Hint regions and islands only depend on the area they're found from,
+// so each area only needs to be searched once for each kind
+static const std::list<std::string>& findRegionsOnce(std::unordered_map<Area*, std::list<std::string>>& foundRegions, Area* area, const std::function<std::list<std::string>()>& findRegions)
+{
+    auto regions = foundRegions.find(area);
+    if (regions == foundRegions.end())
+    {
+        regions = foundRegions.emplace(area, findRegions()).first;
+    }
+    return regions->second;
+}
+
+// Work out what each location's item can lead to in one sweep over the world, so barren and
+// importance checks afterwards are lookups. This uses the chain locations from the parsed
+// requirements and the path locations found by searching through the playthrough
+static void analyzeItemDependencies(World& world)
+{
+    // For the purposes of barren hints, if a major item cannot possibly lead to any
+    // required items, then it will not block the region it's in from being considered
+    // barren. Mark those items as junk first.
+    // Items which aren't junk yet but might be, by the location they're at
+    std::unordered_map<Location*, Item*> potentiallyJunkItems = {};
+    for (auto& [areaName, area] : world.areaTable)
+    {
+        for (auto& locAccess : area->locations)
+        {
+            auto location = locAccess.location;
+            const auto& chainLocations = location->currentItem.getChainLocations();
+            if (!chainLocations.empty())
+            {
+                // If all of this item's chain locations' are barren as chain locations, then this item is barren too.
+                if (std::ranges::all_of(chainLocations, [](const Location* loc){ return loc->isBarrenAsChainLocation(); }))
+                {
+                    location->currentItem.setAsJunkItem();
+                    LOG_TO_DEBUG(location->currentItem.getName() + " is now junk.");
+                }
+                else
+                {
+                    potentiallyJunkItems[location] = &location->currentItem;
+                }
+            }
+        }
+    }
+
+    // An item turning into junk can only make the items which have its location as a chain
+    // location into junk too, so follow those dependencies from each new junk item instead
+    // of checking every potentially junk item again until nothing changes
+    std::unordered_map<Location*, std::vector<Location*>> chainDependents = {};
+    std::vector<Location*> itemsToCheck = {};
+    for (const auto& [location, item] : potentiallyJunkItems)
+    {
+        for (auto chainLocation : item->getChainLocations())
+        {
+            chainDependents[chainLocation].push_back(location);
+        }
+        itemsToCheck.push_back(location);
+    }
+    while (!itemsToCheck.empty())
+    {
+        Location* location = itemsToCheck.back();
+        itemsToCheck.pop_back();
+        Item* item = potentiallyJunkItems[location];
+        if (!item->isJunkItem() && std::ranges::all_of(item->getChainLocations(), [](const Location* loc){ return loc->isBarrenAsChainLocation(); }))
+        {
+            item->setAsJunkItem();
+            LOG_TO_DEBUG(item->getName() + " is now junk.");
+            if (chainDependents.contains(location))
+            {
+                addElementsToPool(itemsToCheck, chainDependents[location]);
+            }
+        }
+    }
+
+    // Items on the path to Ganondorf are always required
+    for (auto location : world.locationTable["Ganon's Tower - Defeat Ganondorf"]->pathLocations)
+    {
+        location->onPathToGanondorf = true;
+    }
+
+    // Now that every item that can be junk is, decide which items could be in a barren region.
+    // Only locations which can affect barren regions need to know
+    for (auto& [name, location] : world.locationTable)
+    {
+        if (location->progression || !std::ranges::all_of(location->outsideDependentLocations, [](const Location* loc){ return loc->isBarrenAsChainLocation(); }))
+        {
+            location->itemCanBeBarren = location->currentItemCanBeBarren();
+        }
+    }
+}
+
 static HintError calculatePossibleBarrenRegions(WorldPool& worlds)
 {
     LOG_TO_DEBUG("Calculating Barren Regions");
     for (auto& world : worlds)
     {
-        std::unordered_set<Item*> potentiallyJunkItems = {};
+        std::unordered_map<Area*, std::list<std::string>> areaHintRegions = {};
+        std::unordered_map<Area*, std::list<std::string>> areaNonIslandHintRegions = {};
+        std::unordered_map<Area*, std::list<std::string>> areaIslands = {};
+
         for (auto& [areaName, area] : world.areaTable)
         {
-            // We'll be performing several operations during this loop
             for (auto& locAccess : area->locations)
             {
                 auto location = locAccess.location;
@@ -122,7 +240,7 @@ static HintError calculatePossibleBarrenRegions(WorldPool& worlds)
                 // have them
                 if (location->hintRegions.empty())
                 {
-                    location->hintRegions = area->findHintRegions();
+                    location->hintRegions = findRegionsOnce(areaHintRegions, area.get(), [&](){ return area->findHintRegions(); });
                 }
                 // If this location is progression, then add its hint regions to
                 // the set of potentially barren regions
@@ -138,25 +256,6 @@ static HintError calculatePossibleBarrenRegions(WorldPool& worlds)
                         world.barrenRegions[region] = {};
                     }
                 }
-
-                // During this loop we'll also go through and mark certain items as junk items.
-                // For the purposes of barren hints, if a major item cannot possibly lead to any
-                // required items, then it will not block the region it's in from being considered
-                // barren.
-                const auto& chainLocations = location->currentItem.getChainLocations();
-                if (!chainLocations.empty())
-                {
-                    // If all of this item's chain locations' are barren as chain locations, then this item is barren too.
-                    if (std::ranges::all_of(chainLocations, [](const Location* loc){ return loc->isBarrenAsChainLocation(); }))
-                    {
-                        location->currentItem.setAsJunkItem();
-                        LOG_TO_DEBUG(location->currentItem.getName() + " is now junk.");
-                    }
-                    else
-                    {
-                        potentiallyJunkItems.insert(&location->currentItem);
-                    }
-                }
             }
         }
         #ifdef ENABLE_DEBUG
@@ -168,23 +267,7 @@ static HintError calculatePossibleBarrenRegions(WorldPool& worlds)
             LOG_TO_DEBUG("]");
         #endif
 
-        // Loop through the potentially junk items until no new junk items have been
-        // found incase the locations of chain items are themselves chained together
-        bool newJunkItems;
-        do
-        {
-            newJunkItems = false;
-            for (Item* item : potentiallyJunkItems)
-            {
-                if (!item->isJunkItem() && std::ranges::all_of(item->getChainLocations(), [](const Location* loc){ return loc->isBarrenAsChainLocation(); }))
-                {
-                    newJunkItems = true;
-                    item->setAsJunkItem();
-                    LOG_TO_DEBUG(item->getName() + " is now junk.");
-                }
-            }
-        }
-        while (newJunkItems);
+        analyzeItemDependencies(world);
 
         // Now loop through all the progression locations again and remove any
         // regions from the barren regions map which have non-junk items at any
@@ -205,12 +288,14 @@ static HintError calculatePossibleBarrenRegions(WorldPool& worlds)
 
             if(!canBlockBarren && nonBarrenDependent == nullptr) continue;
 
-            const bool& isBarren = location->currentItemCanBeBarren();
+            const bool& isBarren = location->itemCanBeBarren;
 
             for(const auto& locAccess : location->accessPoints) {
                 const auto& area = locAccess->area;
-                for(const auto& hintRegions : {area->findHintRegions(true), area->findIslands()}) {
-                    for(const auto& hintRegion : hintRegions) {
+                const auto& nonIslandHintRegions = findRegionsOnce(areaNonIslandHintRegions, area, [&](){ return area->findHintRegions(true); });
+                const auto& islands = findRegionsOnce(areaIslands, area, [&](){ return area->findIslands(); });
+                for(const auto* hintRegions : {&nonIslandHintRegions, &islands}) {
+                    for(const auto& hintRegion : *hintRegions) {
                         if(world.barrenRegions.contains(hintRegion)) {
                             if(canBlockBarren) {
                                 if(isBarren) {
@@ -0,0 +1,476 @@
+
+#include "IncrementalSearch.hpp"
+
+#include <algorithm>
+#include <cassert>
+
+#include <command/Log.hpp>
+
+// Only items which aren't junk are picked up from locations, same as the regular search
+static bool countsForLogic(const Item& item)
+{
+    return item.getGameItemId() != GameItem::INVALID && !item.isJunkItem();
+}
+
+IncrementalSearch::IncrementalSearch(WorldPool& worlds, const ItemPool& items /*= {}*/, int worldToSearch /*= -1*/) :
+    numWorlds(worlds.size()),
+    inventory(items),
+    itemDependents(worlds.size())
+{
+    inventory.trackAreas();
+
+    // Give every area, event and location a node
+    for (auto& world : worlds)
+    {
+        assert(world.logicRequirementsAreCompiled());
+
+        areaOffsets.push_back(nodes.size());
+        for (const auto area : world.areasByIndex)
+        {
+            nodes.push_back({NodeType::AREA, area, nullptr, world.getWorldId()});
+        }
+
+        eventOffsets.push_back(nodes.size());
+        for (EventId event = 0; event < world.eventMap.size(); event++)
+        {
+            nodes.push_back({NodeType::EVENT, nullptr, nullptr, world.getWorldId(), event});
+        }
+
+        locationOffsets.push_back(nodes.size());
+        for (const auto location : world.locationsByIndex)
+        {
+            nodes.push_back({NodeType::LOCATION, nullptr, location, world.getWorldId()});
+        }
+    }
+
+    // Then connect the nodes with every access in the worlds
+    std::vector<int> rootAccesses = {};
+    for (auto& world : worlds)
+    {
+        const bool searchingWorld = worldToSearch == -1 || worldToSearch == world.getWorldId();
+        for (const auto area : world.areasByIndex)
+        {
+            const int node = areaNode(area);
+            for (auto& exit : area->exits)
+            {
+                if (exit.getConnectedArea() == nullptr)
+                {
+                    continue;
+                }
+                // The search starts from the root exits without making the root
+                // itself accessible
+                if (searchingWorld && area == world.root)
+                {
+                    rootAccesses.push_back(accesses.size());
+                    addAccess({&exit.getRequirementProgram(), &exit, -1, areaNode(exit.getConnectedArea())});
+                }
+                else
+                {
+                    addAccess({&exit.getRequirementProgram(), &exit, node, areaNode(exit.getConnectedArea())});
+                }
+            }
+            for (auto& eventAccess : area->events)
+            {
+                addAccess({&eventAccess.program, nullptr, node, eventOffsets[world.getWorldId()] + static_cast<int>(eventAccess.event)});
+            }
+            for (auto& locAccess : area->locations)
+            {
+                addAccess({&locAccess.program, nullptr, node, locationNode(locAccess.location)});
+            }
+        }
+
+        // Reset search variables for all areas, exits and locations
+        for (const auto area : world.areasByIndex)
+        {
+            area->isAccessible = false;
+        }
+        for (const auto exit : world.entrancesByIndex)
+        {
+            if (exit != nullptr)
+            {
+                exit->setFound(false);
+            }
+        }
+        for (const auto location : world.locationsByIndex)
+        {
+            location->hasBeenFound = false;
+        }
+
+        if (searchingWorld)
+        {
+            inventory.addItems(world.getStartingItems());
+        }
+    }
+
+    for (const auto& access : rootAccesses)
+    {
+        queue(access);
+    }
+    run();
+}
+
+int IncrementalSearch::areaNode(const Area* area) const
+{
+    return areaOffsets[area->world->getWorldId()] + area->index;
+}
+
+int IncrementalSearch::locationNode(const Location* location) const
+{
+    return locationOffsets[location->world->getWorldId()] + location->index;
+}
+
+void IncrementalSearch::addAccess(const Access& access)
+{
+    const int index = accesses.size();
+    accesses.push_back(access);
+    if (access.source != -1)
+    {
+        nodes[access.source].outgoing.push_back(index);
+    }
+    nodes[access.target].incoming.push_back(index);
+
+    // Build the reverse dependencies from everything the access checks for.
+    // A requirement can mention the same thing multiple times, so only add
+    // the access once per dependency
+    auto addDependent = [index](std::vector<int>& dependents){
+        if (dependents.empty() || dependents.back() != index)
+        {
+            dependents.push_back(index);
+        }
+    };
+    access.program->forEachDependency(
+        [&](int worldId, GameItem gameItem){
+            if (static_cast<size_t>(worldId) < itemDependents.size())
+            {
+                addDependent(itemDependents[worldId][static_cast<uint8_t>(gameItem)]);
+            }
+        },
+        [&](int worldId, EventId event){
+            addDependent(nodes[eventOffsets[worldId] + event].dependents);
+        },
+        [&](Area* area){
+            addDependent(nodes[areaNode(area)].dependents);
+        }
+    );
+}
+
+// Add an access to the worklist if it could reach something new
+void IncrementalSearch::queue(int index)
+{
+    Access& access = accesses[index];
+    if (access.queued || nodes[access.target].position != -1 || (access.source != -1 && nodes[access.source].position == -1))
+    {
+        return;
+    }
+    access.queued = true;
+    worklist.push_back(index);
+}
+
+void IncrementalSearch::queueItemDependents(int worldId, GameItem gameItem)
+{
+    for (const auto& access : itemDependents[worldId][static_cast<uint8_t>(gameItem)])
+    {
+        queue(access);
+    }
+}
+
+void IncrementalSearch::reach(int index, int accessIndex)
+{
+    Node& node = nodes[index];
+    node.position = log.size();
+    accesses[accessIndex].derivedAt = node.position;
+    log.push_back({index, accessIndex});
+
+    switch (node.type)
+    {
+    case NodeType::AREA:
+        inventory.addArea(node.worldId, node.area->index);
+        if (updateWorlds)
+        {
+            node.area->isAccessible = true;
+            if (accesses[accessIndex].exit != nullptr)
+            {
+                accesses[accessIndex].exit->setFound(true);
+            }
+        }
+        for (const auto& access : node.outgoing)
+        {
+            queue(access);
+        }
+        break;
+    case NodeType::EVENT:
+        inventory.addEvent(node.worldId, node.event);
+        break;
+    case NodeType::LOCATION:
+    {
+        if (updateWorlds)
+        {
+            node.location->hasBeenFound = true;
+        }
+        const Item& item = node.location->currentItem;
+        if (picksUpItem(node))
+        {
+            log.back().itemWorldId = item.getWorldId();
+            log.back().item = item.getGameItemId();
+            inventory.addItem(item);
+            queueItemDependents(item.getWorldId(), item.getGameItemId());
+        }
+        break;
+    }
+    }
+
+    for (const auto& access : node.dependents)
+    {
+        queue(access);
+    }
+}
+
+// Undo every log entry from position onwards, then queue the accesses which could
+// reach the undone nodes again
+void IncrementalSearch::rollback(size_t position)
+{
+    if (position >= log.size())
+    {
+        return;
+    }
+
+    std::vector<int> undoneNodes = {};
+    for (size_t i = log.size(); i-- > position; )
+    {
+        const LogEntry& entry = log[i];
+        Node& node = nodes[entry.node];
+        node.position = -1;
+        accesses[entry.access].derivedAt = -1;
+        undoneNodes.push_back(entry.node);
+
+        switch (node.type)
+        {
+        case NodeType::AREA:
+            inventory.removeArea(node.worldId, node.area->index);
+            if (updateWorlds)
+            {
+                node.area->isAccessible = false;
+                if (accesses[entry.access].exit != nullptr)
+                {
+                    accesses[entry.access].exit->setFound(false);
+                }
+            }
+            break;
+        case NodeType::EVENT:
+            inventory.removeEvent(node.worldId, node.event);
+            break;
+        case NodeType::LOCATION:
+            if (updateWorlds)
+            {
+                node.location->hasBeenFound = false;
+            }
+            if (entry.item != GameItem::INVALID)
+            {
+                inventory.removeItem(entry.itemWorldId, entry.item);
+            }
+            break;
+        }
+    }
+    log.resize(position);
+
+    for (const auto& node : undoneNodes)
+    {
+        for (const auto& access : nodes[node].incoming)
+        {
+            queue(access);
+        }
+    }
+}
+
+// Find the earliest log entry after acquiredAt which was reached by an access
+// mentioning the given item. Entries before it don't depend on the item.
+size_t IncrementalSearch::firstDependentPosition(int worldId, GameItem gameItem, int acquiredAt) const
+{
+    size_t position = log.size();
+    for (const auto& access : itemDependents[worldId][static_cast<uint8_t>(gameItem)])
+    {
+        const int derivedAt = accesses[access].derivedAt;
+        if (derivedAt > acquiredAt && static_cast<size_t>(derivedAt) < position)
+        {
+            position = derivedAt;
+        }
+    }
+    return position;
+}
+
+bool IncrementalSearch::picksUpItem(const Node& node) const
+{
+    return !node.itemIgnored && countsForLogic(node.location->currentItem);
+}
+
+void IncrementalSearch::run()
+{
+    while (!worklist.empty())
+    {
+        const int index = worklist.back();
+        worklist.pop_back();
+        Access& access = accesses[index];
+        access.queued = false;
+
+        // Things may have been reached since this access was queued
+        if (nodes[access.target].position != -1 || (access.source != -1 && nodes[access.source].position == -1))
+        {
+            continue;
+        }
+        if (access.program->evaluate(&inventory))
+        {
+            reach(access.target, index);
+        }
+    }
+}
+
+void IncrementalSearch::addItem(const Item& item)
+{
+    inventory.addItem(item);
+    queueItemDependents(item.getWorldId(), item.getGameItemId());
+    run();
+}
+
+void IncrementalSearch::removeItem(const Item& item)
+{
+    rollback(firstDependentPosition(item.getWorldId(), item.getGameItemId(), -1));
+    inventory.removeItem(item);
+    run();
+}
+
+void IncrementalSearch::updateLocation(Location* location)
+{
+    refreshLocationItem(locationNode(location));
+}
+
+void IncrementalSearch::ignoreLocationItem(Location* location, const bool& ignore /*= true*/)
+{
+    const int index = locationNode(location);
+    nodes[index].itemIgnored = ignore;
+    refreshLocationItem(index);
+}
+
+// Swap the item picked up at a location node for whatever is there now
+void IncrementalSearch::refreshLocationItem(int index)
+{
+    // If the location hasn't been reached, its item will be picked up once it is
+    const Node& node = nodes[index];
+    const int position = node.position;
+    if (position == -1)
+    {
+        return;
+    }
+
+    const Item& newItem = node.location->currentItem;
+    const bool newItemCounts = picksUpItem(node);
+    const LogEntry& oldEntry = log[position];
+    if (oldEntry.item != GameItem::INVALID)
+    {
+        if (newItemCounts && oldEntry.itemWorldId == newItem.getWorldId() && oldEntry.item == newItem.getGameItemId())
+        {
+            return;
+        }
+        const int oldWorldId = oldEntry.itemWorldId;
+        const GameItem oldItem = oldEntry.item;
+        rollback(firstDependentPosition(oldWorldId, oldItem, position));
+        inventory.removeItem(oldWorldId, oldItem);
+    }
+
+    LogEntry& entry = log[position];
+    entry.itemWorldId = -1;
+    entry.item = GameItem::INVALID;
+    if (newItemCounts)
+    {
+        entry.itemWorldId = newItem.getWorldId();
+        entry.item = newItem.getGameItemId();
+        inventory.addItem(newItem);
+        queueItemDependents(entry.itemWorldId, entry.item);
+    }
+    run();
+}
+
+bool IncrementalSearch::itemOnFrontier(const Item& item) const
+{
+    if (static_cast<size_t>(item.getWorldId()) >= itemDependents.size())
+    {
+        return false;
+    }
+    return std::ranges::any_of(itemDependents[item.getWorldId()][static_cast<uint8_t>(item.getGameItemId())], [this](const int& index){
+        const Access& access = accesses[index];
+        return nodes[access.target].position == -1 && (access.source == -1 || nodes[access.source].position != -1);
+    });
+}
+
+bool IncrementalSearch::itemStillNeeded(const Item& item) const
+{
+    if (static_cast<size_t>(item.getWorldId()) >= itemDependents.size())
+    {
+        return false;
+    }
+    return std::ranges::any_of(itemDependents[item.getWorldId()][static_cast<uint8_t>(item.getGameItemId())], [this](const int& index){
+        return nodes[accesses[index].target].position == -1;
+    });
+}
+
+// Whether the search has reached the given location
+bool IncrementalSearch::locationReachable(Location* location) const
+{
+    return nodes[locationNode(location)].position != -1;
+}
+
+// Checks to see if the specific locations from the passed in location pool are all accessible
+bool IncrementalSearch::locationsReachable(const LocationPool& locationsToCheck) const
+{
+    return std::ranges::all_of(locationsToCheck, [this](Location* loc){
+        const bool found = locationReachable(loc);
+        if (!found)
+        {
+            LOG_TO_DEBUG("Missing location " + loc->getName());
+        }
+        return found;
+    });
+}
+
+bool IncrementalSearch::gameBeatable() const
+{
+    size_t worldsBeatable = 0;
+    for (const auto& entry : log)
+    {
+        const Node& node = nodes[entry.node];
+        if (node.type == NodeType::LOCATION && node.location->currentItem.getGameItemId() == GameItem::GameBeatable)
+        {
+            worldsBeatable++;
+        }
+    }
+    return worldsBeatable == numWorlds;
+}
+
+// Returns the reachable locations in the order they were reached
+LocationPool IncrementalSearch::getAccessibleLocations() const
+{
+    LocationPool accessibleLocations = {};
+    for (const auto& entry : log)
+    {
+        if (nodes[entry.node].type == NodeType::LOCATION)
+        {
+            accessibleLocations.push_back(nodes[entry.node].location);
+        }
+    }
+    return accessibleLocations;
+}
+
+// Returns the reachable locations which are allowed and don't have an item yet,
+// in the order they were reached
+LocationPool IncrementalSearch::getAccessibleLocations(const LocationMask& allowedLocations) const
+{
+    LocationPool accessibleLocations = {};
+    for (const auto& entry : log)
+    {
+        const Node& node = nodes[entry.node];
+        if (node.type == NodeType::LOCATION && allowedLocations.contains(node.location) && node.location->currentItem.getGameItemId() == GameItem::INVALID)
+        {
+            accessibleLocations.push_back(node.location);
+        }
+    }
+    return accessibleLocations;
+}
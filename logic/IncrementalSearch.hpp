@@ -0,0 +1,112 @@
+
+#pragma once
+
+#include <array>
+#include <vector>
+
+#include <logic/World.hpp>
+#include <logic/Inventory.hpp>
+
+// A search which keeps its results between item changes. Every area, event and
+// location which becomes reachable is appended to a log along with the access
+// that reached it. Adding an item only re-evaluates the accesses which mention
+// that item. Removing an item rolls the log back to the first entry reached by
+// an access mentioning it (everything before that entry can't have needed the
+// item) and continues the search from there.
+//
+// The search variables on the worlds (Area::isAccessible, Location::hasBeenFound
+// and found exits) are kept up to date as the search changes. Nothing else should
+// search the worlds or change their entrances while an IncrementalSearch is in use.
+// A detached search only keeps its results to itself, so copies of it can be
+// searched on separate threads as long as nothing changes the worlds meanwhile.
+class IncrementalSearch
+{
+public:
+    IncrementalSearch(WorldPool& worlds, const ItemPool& items = {}, int worldToSearch = -1);
+
+    void addItem(const Item& item);
+    void removeItem(const Item& item);
+    // Call after changing the current item at a location
+    void updateLocation(Location* location);
+    // Search as if the location had no item, without changing the location
+    void ignoreLocationItem(Location* location, const bool& ignore = true);
+    // Stop writing search results to the worlds
+    void detach() { updateWorlds = false; }
+
+    // Whether some access out of a reached area into something unreached checks for the item,
+    // so adding it could reach something new right away
+    bool itemOnFrontier(const Item& item) const;
+    // Whether anything which hasn't been reached checks for the item at all
+    bool itemStillNeeded(const Item& item) const;
+
+    bool locationReachable(Location* location) const;
+    bool locationsReachable(const LocationPool& locationsToCheck) const;
+    bool gameBeatable() const;
+    LocationPool getAccessibleLocations() const;
+    LocationPool getAccessibleLocations(const LocationMask& allowedLocations) const;
+
+private:
+    enum struct NodeType
+    {
+        AREA = 0,
+        EVENT,
+        LOCATION,
+    };
+
+    struct Node
+    {
+        NodeType type = NodeType::AREA;
+        Area* area = nullptr;
+        Location* location = nullptr;
+        int worldId = -1;
+        EventId event = 0;
+        int position = -1;                // Index into the log once this node is reached
+        bool itemIgnored = false;         // Location's item isn't picked up
+        std::vector<int> incoming = {};   // Accesses which reach this node
+        std::vector<int> outgoing = {};   // Accesses from within this area
+        std::vector<int> dependents = {}; // Accesses which check for this area or event
+    };
+
+    struct Access
+    {
+        const RequirementProgram* program = nullptr;
+        Entrance* exit = nullptr;
+        int source = -1; // Node of the area this access is in, or -1 for the root exits being searched
+        int target = -1;
+        int derivedAt = -1;
+        bool queued = false;
+    };
+
+    struct LogEntry
+    {
+        int node = -1;
+        int access = -1;
+        int itemWorldId = -1; // Item picked up at a location node, if it counts for logic
+        GameItem item = GameItem::INVALID;
+    };
+
+    int areaNode(const Area* area) const;
+    int locationNode(const Location* location) const;
+    void addAccess(const Access& access);
+    void queue(int access);
+    void queueItemDependents(int worldId, GameItem gameItem);
+    void reach(int node, int access);
+    void rollback(size_t position);
+    size_t firstDependentPosition(int worldId, GameItem gameItem, int acquiredAt) const;
+    bool picksUpItem(const Node& node) const;
+    void refreshLocationItem(int index);
+    void run();
+
+    size_t numWorlds = 0;
+    Inventory inventory = {};
+    std::vector<Node> nodes = {};
+    std::vector<Access> accesses = {};
+    std::vector<LogEntry> log = {};
+    std::vector<int> worklist = {};
+    std::vector<std::array<std::vector<int>, 256>> itemDependents = {};
+    // Each world's nodes start at these offsets and are in index order
+    std::vector<int> areaOffsets = {};
+    std::vector<int> eventOffsets = {};
+    std::vector<int> locationOffsets = {};
+    bool updateWorlds = true;
+};
@@ -0,0 +1,133 @@
+
+#include "Inventory.hpp"
+
+Inventory::Inventory(const ItemPool& items)
+{
+    addItems(items);
+}
+
+Inventory::WorldInventory& Inventory::getWorldInventory(int worldId)
+{
+    if (static_cast<size_t>(worldId) >= worlds.size())
+    {
+        worlds.resize(worldId + 1);
+    }
+    return worlds[worldId];
+}
+
+void Inventory::reserveWorlds(size_t numWorlds)
+{
+    if (worlds.size() < numWorlds)
+    {
+        worlds.resize(numWorlds);
+    }
+}
+
+void Inventory::addItem(const Item& item)
+{
+    addItem(item.getWorldId(), item.getGameItemId());
+}
+
+void Inventory::addItem(int worldId, GameItem gameItem)
+{
+    getWorldInventory(worldId).itemCounts[static_cast<uint8_t>(gameItem)]++;
+}
+
+void Inventory::addItems(const ItemPool& items)
+{
+    for (const auto& item : items)
+    {
+        addItem(item);
+    }
+}
+
+void Inventory::removeItem(const Item& item)
+{
+    removeItem(item.getWorldId(), item.getGameItemId());
+}
+
+void Inventory::removeItem(int worldId, GameItem gameItem)
+{
+    auto& count = getWorldInventory(worldId).itemCounts[static_cast<uint8_t>(gameItem)];
+    if (count > 0)
+    {
+        count--;
+    }
+}
+
+bool Inventory::hasItem(const Item& item) const
+{
+    return itemCount(item) > 0;
+}
+
+uint32_t Inventory::itemCount(const Item& item) const
+{
+    return itemCount(item.getWorldId(), item.getGameItemId());
+}
+
+uint32_t Inventory::itemCount(int worldId, GameItem gameItem) const
+{
+    if (static_cast<size_t>(worldId) >= worlds.size())
+    {
+        return 0;
+    }
+    return worlds[worldId].itemCounts[static_cast<uint8_t>(gameItem)];
+}
+
+void Inventory::addEvent(int worldId, EventId event)
+{
+    auto& events = getWorldInventory(worldId).events;
+    if (event / 64 >= events.size())
+    {
+        events.resize(event / 64 + 1);
+    }
+    events[event / 64] |= uint64_t(1) << (event % 64);
+}
+
+void Inventory::removeEvent(int worldId, EventId event)
+{
+    auto& events = getWorldInventory(worldId).events;
+    if (event / 64 < events.size())
+    {
+        events[event / 64] &= ~(uint64_t(1) << (event % 64));
+    }
+}
+
+bool Inventory::hasEvent(int worldId, EventId event) const
+{
+    if (static_cast<size_t>(worldId) >= worlds.size())
+    {
+        return false;
+    }
+    const auto& events = worlds[worldId].events;
+    return event / 64 < events.size() && (events[event / 64] >> (event % 64)) & 1;
+}
+
+void Inventory::addArea(int worldId, int areaIndex)
+{
+    auto& areas = getWorldInventory(worldId).areas;
+    if (static_cast<size_t>(areaIndex / 64) >= areas.size())
+    {
+        areas.resize(areaIndex / 64 + 1);
+    }
+    areas[areaIndex / 64] |= uint64_t(1) << (areaIndex % 64);
+}
+
+void Inventory::removeArea(int worldId, int areaIndex)
+{
+    auto& areas = getWorldInventory(worldId).areas;
+    if (static_cast<size_t>(areaIndex / 64) < areas.size())
+    {
+        areas[areaIndex / 64] &= ~(uint64_t(1) << (areaIndex % 64));
+    }
+}
+
+bool Inventory::canAccess(int worldId, int areaIndex) const
+{
+    if (static_cast<size_t>(worldId) >= worlds.size())
+    {
+        return false;
+    }
+    const auto& areas = worlds[worldId].areas;
+    return static_cast<size_t>(areaIndex / 64) < areas.size() && (areas[areaIndex / 64] >> (areaIndex % 64)) & 1;
+}
@@ -0,0 +1,59 @@
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+#include <logic/GameItem.hpp>
+#include <logic/ItemPool.hpp>
+#include <logic/Requirements.hpp>
+
+// Dense item and event ownership for the searching algorithm. Item counts are
+// kept in a fixed array per world indexed by GameItem, and events are a bitset
+// per world indexed by EventId, so checking a requirement is a load and compare
+// and copying an inventory doesn't have to rebuild any hash tables.
+class Inventory
+{
+public:
+    Inventory() = default;
+    explicit Inventory(const ItemPool& items);
+
+    // Make room for this many worlds up front, so each world's items and
+    // events can be changed from a separate thread
+    void reserveWorlds(size_t numWorlds);
+
+    void addItem(const Item& item);
+    void addItems(const ItemPool& items);
+    void addItem(int worldId, GameItem gameItem);
+    void removeItem(const Item& item);
+    void removeItem(int worldId, GameItem gameItem);
+    bool hasItem(const Item& item) const;
+    uint32_t itemCount(const Item& item) const;
+    uint32_t itemCount(int worldId, GameItem gameItem) const;
+
+    void addEvent(int worldId, EventId event);
+    void removeEvent(int worldId, EventId event);
+    bool hasEvent(int worldId, EventId event) const;
+
+    // Searches which run alongside others can't use Area::isAccessible, so they
+    // keep the areas they reach here instead (indexed by Area::index)
+    void trackAreas() { areasTracked = true; }
+    bool tracksAreas() const { return areasTracked; }
+    void addArea(int worldId, int areaIndex);
+    void removeArea(int worldId, int areaIndex);
+    bool canAccess(int worldId, int areaIndex) const;
+
+private:
+    struct WorldInventory
+    {
+        std::array<uint16_t, 256> itemCounts = {};
+        std::vector<uint64_t> events = {};
+        std::vector<uint64_t> areas = {};
+    };
+
+    WorldInventory& getWorldInventory(int worldId);
+
+    std::vector<WorldInventory> worlds = {};
+    bool areasTracked = false;
+};
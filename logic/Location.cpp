@@ -1,10 +1,13 @@
 
 #include "Location.hpp"
 
+#include <cassert>
+#include <optional>
 #include <unordered_map>
 #include <string>
 
 #include <logic/World.hpp>
+#include <logic/Inventory.hpp>
 #include <filetypes/util/msbtMacros.hpp>
 
 LocationCategory nameToLocationCategory(const std::string& name)
@@ -122,6 +125,49 @@ bool Location::operator<(const Location& rhs) const
     return this->sortPriority < rhs.sortPriority;
 }
 
+LocationMask::LocationMask(const std::vector<Location*>& locations)
+{
+    for (const auto location : locations)
+    {
+        add(location);
+    }
+}
+
+void LocationMask::add(const Location* location)
+{
+    const size_t worldId = location->world->getWorldId();
+    if (worldId >= worlds.size())
+    {
+        worlds.resize(worldId + 1);
+    }
+    auto& bits = worlds[worldId];
+    if (static_cast<size_t>(location->index / 64) >= bits.size())
+    {
+        bits.resize(location->index / 64 + 1);
+    }
+    bits[location->index / 64] |= uint64_t(1) << (location->index % 64);
+}
+
+void LocationMask::remove(const Location* location)
+{
+    const size_t worldId = location->world->getWorldId();
+    if (worldId < worlds.size() && static_cast<size_t>(location->index / 64) < worlds[worldId].size())
+    {
+        worlds[worldId][location->index / 64] &= ~(uint64_t(1) << (location->index % 64));
+    }
+}
+
+bool LocationMask::contains(const Location* location) const
+{
+    const size_t worldId = location->world->getWorldId();
+    if (worldId >= worlds.size())
+    {
+        return false;
+    }
+    const auto& bits = worlds[worldId];
+    return static_cast<size_t>(location->index / 64) < bits.size() && (bits[location->index / 64] >> (location->index % 64)) & 1;
+}
+
 std::string Location::getName() const
 {
     if (names.contains("English"))
@@ -144,31 +190,31 @@ bool Location::currentItemCanBeBarren() const
         return true;
     }
 
-    // Get a pool of start items and all items from this location's logically required path locations
-    ItemMultiSet logicallyRequiredItems = {};
-    for (const auto& item : world->getStartingItems())
-    {
-        logicallyRequiredItems.insert(item);
-    }
-    for (const auto& pathLoc : this->pathLocations)
-    {
-        logicallyRequiredItems.insert(pathLoc->currentItem);
-    }
+    // Get a pool of start items and all items from this location's logically required path locations.
+    // It's only needed if one of the item's progression chain locations isn't barren, so only build it then
+    std::optional<Inventory> logicallyRequiredItems;
+    assert(currentItem.getWorld()->logicRequirementsAreCompiled());
 
-    // Dummy ownedEvents for evaluation
-    EventSet ownedEvents = {};
+    // If any of the item's chain locations have an item which can't be barren, or the location is a required race mode location,
+    // then this location's item isn't barren. Chain locations which can be obtained with the items logically necessary to get
+    // the item at this location don't count, as this item will not help to obtain that specific chain location
+    for (const auto& location : currentItem.getChainLocations())
+    {
+        if (!location->progression || location->isBarrenAsChainLocation())
+        {
+            continue;
+        }
 
-    // Get all the progression chain locations for this location's item
-    auto chainLocations = currentItem.getChainLocations();
-    // If any of the item's chain locations can be obtained with the items logically necessary to get the item at this location,
-    // then remove those locations from the list of chain locations, as this item will not help to obtain that specific chain location
-    std::erase_if(chainLocations, [&](const auto& loc) { return !loc->progression || evaluateRequirement(world, loc->computedRequirement, &logicallyRequiredItems, &ownedEvents); });
+        if (!logicallyRequiredItems.has_value())
+        {
+            logicallyRequiredItems.emplace(world->getStartingItemsReference());
+            for (const auto& pathLoc : this->pathLocations)
+            {
+                logicallyRequiredItems->addItem(pathLoc->currentItem);
+            }
+        }
 
-    // If any of the remaining chain locations have an item which can't be barren, or the location is a required race mode location, 
-    // then this location's item isn't barren.
-    for (auto& location : chainLocations)
-    {
-        if (!location->isBarrenAsChainLocation())
+        if (!location->computedRequirementProgram.evaluate(&logicallyRequiredItems.value()))
         {
             return false;
         }
@@ -216,13 +262,13 @@ std::u16string Location::generateImportanceText(const std::string& language) con
     }
 
     // If this item is on the path to Ganondorf, then it is required
-    const auto& requiredLocations = world->locationTable["Ganon's Tower - Defeat Ganondorf"]->pathLocations;
-    if (elementInPool(this, requiredLocations))
+    if (onPathToGanondorf)
     {
         return u" (" + TEXT_COLOR_GREEN + required + TEXT_COLOR_DEFAULT + u")";
     }
 
-    // If this item can be in a barren region, then it's not required
+    // If this item can be in a barren region, then it's not required. This can't use itemCanBeBarren,
+    // since items in worlds analyzed after this one may have become junk since then
     if (currentItemCanBeBarren())
     {
         return u" (" + TEXT_COLOR_GRAY + notRequired + TEXT_COLOR_DEFAULT + u")";
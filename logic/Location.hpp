@@ -82,14 +82,18 @@ public:
     Item originalItem;
     Item currentItem;
     int sortPriority = -1;
+    int index = -1; // Position of this location within its world, for indexed lookups
     std::list<std::string> hintRegions;
     std::list<LocationAccess*> accessPoints;
     std::string hintPriority = "";
     std::unique_ptr<LocationModification> method;
     World* world = nullptr;
     Requirement computedRequirement = Requirement{RequirementType::IMPOSSIBLE, {}};
+    RequirementProgram computedRequirementProgram;
     std::unordered_set<GameItem> itemsInComputedRequirement = {};
     std::vector<Location*> pathLocations = {};
+    bool onPathToGanondorf = false; // Set when hints are generated
+    bool itemCanBeBarren = false; // Set when hints are generated, from currentItemCanBeBarren()
 
     // Locations which always require completing this one first regardless of what item it has
     std::list<Location*> outsideDependentLocations = {};
@@ -147,3 +151,19 @@ public:
 };
 
 using LocationSet = std::set<Location*, PointerLess<Location>>;
+
+// Constant time membership for a pool of locations, indexed by world id and location index.
+// Build once for a pool which is checked against repeatedly
+class LocationMask
+{
+public:
+    LocationMask() = default;
+    explicit LocationMask(const std::vector<Location*>& locations);
+
+    void add(const Location* location);
+    void remove(const Location* location);
+    bool contains(const Location* location) const;
+
+private:
+    std::vector<std::vector<uint64_t>> worlds = {};
+};
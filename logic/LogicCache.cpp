@@ -0,0 +1,308 @@
+
+#include "LogicCache.hpp"
+
+#include <array>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+
+#include <version.hpp>
+#include <libs/hashing.hpp>
+#include <logic/WorldTemplate.hpp>
+
+static constexpr uint32_t LOGIC_CACHE_MAGIC = 0x434C5757; // "WWLC"
+static constexpr uint32_t LOGIC_CACHE_FORMAT = 1;
+static constexpr size_t NUM_TREES = 6;
+
+enum struct CachedNodeType : uint32_t
+{
+    NIL = 0,
+    SCALAR,
+    SEQUENCE,
+    MAP,
+};
+
+struct CacheHeader
+{
+    uint32_t magic = LOGIC_CACHE_MAGIC;
+    uint32_t format = LOGIC_CACHE_FORMAT;
+    uint32_t nodeCount = 0;
+    uint32_t childCount = 0;
+    uint32_t stringBytes = 0;
+    uint32_t roots[NUM_TREES] = {};
+    char sourceHash[SHA1::HashBytes] = {};
+};
+
+// Scalars point into the string data. Sequences point to their children, and
+// maps to their keys and values stored as pairs
+struct CachedNode
+{
+    CachedNodeType type = CachedNodeType::NIL;
+    uint32_t first = 0;
+    uint32_t count = 0;
+};
+
+static std::array<const YAML::Node*, NUM_TREES> templateTrees(const WorldTemplate& worldTemplate)
+{
+    return {&worldTemplate.worldData, &worldTemplate.macros, &worldTemplate.locationData, &worldTemplate.itemData, &worldTemplate.areaData, &worldTemplate.dungeonEntranceInfo};
+}
+
+fspath getPrebuiltLogicCachePath()
+{
+    return Utility::get_data_path() / "logic/logic_cache.bin";
+}
+
+fspath getLogicCachePath()
+{
+    return Utility::get_app_save_path() / "logic_cache.bin";
+}
+
+std::string logicCacheHash(const std::vector<std::string>& sourceFiles)
+{
+    SHA1 sha1;
+    const std::string version = RANDOMIZER_VERSION;
+    sha1.add(version.data(), version.size());
+    sha1.add(&LOGIC_CACHE_FORMAT, sizeof(LOGIC_CACHE_FORMAT));
+    for (const auto& file : sourceFiles)
+    {
+        const uint64_t size = file.size();
+        sha1.add(&size, sizeof(size));
+        sha1.add(file.data(), file.size());
+    }
+    return sha1.getHash();
+}
+
+LogicCacheError loadLogicCache(const fspath& cachePath, WorldTemplate& worldTemplate)
+{
+    std::ifstream file(cachePath, std::ios::binary);
+    if (!file.is_open())
+    {
+        return LogicCacheError::COULD_NOT_OPEN;
+    }
+
+    CacheHeader header;
+    if (!file.read(reinterpret_cast<char*>(&header), sizeof(header)) || header.magic != LOGIC_CACHE_MAGIC || header.format != LOGIC_CACHE_FORMAT)
+    {
+        return LogicCacheError::BAD_HEADER;
+    }
+    if (std::string(header.sourceHash, sizeof(header.sourceHash)) != worldTemplate.sourceHash)
+    {
+        return LogicCacheError::HASH_MISMATCH;
+    }
+
+    // Only size anything from the counts once they match the file exactly, so a damaged
+    // header is reported as corrupt instead of asking for more memory than there is
+    std::error_code ec;
+    const uintmax_t fileSize = std::filesystem::file_size(cachePath, ec);
+    const uint64_t expectedSize = sizeof(header) + static_cast<uint64_t>(header.nodeCount) * sizeof(CachedNode) + static_cast<uint64_t>(header.childCount) * sizeof(uint32_t) + header.stringBytes;
+    if (ec || fileSize != expectedSize)
+    {
+        return LogicCacheError::CORRUPT_DATA;
+    }
+
+    // Everything after the header is read as one block
+    std::vector<CachedNode> nodes(header.nodeCount);
+    std::vector<uint32_t> children(header.childCount);
+    std::string strings(header.stringBytes, '\0');
+    if (!file.read(reinterpret_cast<char*>(nodes.data()), nodes.size() * sizeof(CachedNode)) ||
+        !file.read(reinterpret_cast<char*>(children.data()), children.size() * sizeof(uint32_t)) ||
+        !file.read(strings.data(), strings.size()))
+    {
+        return LogicCacheError::CORRUPT_DATA;
+    }
+
+    // Validate every index before building anything so a damaged file can't read
+    // out of bounds. Children are always written before their parents, so a child
+    // index must be lower than its parent's, which also rules out cycles
+    for (size_t i = 0; i < nodes.size(); i++)
+    {
+        const CachedNode& node = nodes[i];
+        if (node.type > CachedNodeType::MAP)
+        {
+            return LogicCacheError::CORRUPT_DATA;
+        }
+        if (node.type == CachedNodeType::SCALAR && static_cast<uint64_t>(node.first) + node.count > strings.size())
+        {
+            return LogicCacheError::CORRUPT_DATA;
+        }
+        if (node.type == CachedNodeType::SEQUENCE || node.type == CachedNodeType::MAP)
+        {
+            const uint64_t end = static_cast<uint64_t>(node.first) + node.count * (node.type == CachedNodeType::MAP ? 2ULL : 1ULL);
+            if (end > children.size())
+            {
+                return LogicCacheError::CORRUPT_DATA;
+            }
+            for (uint64_t child = node.first; child < end; child++)
+            {
+                if (children[child] >= i)
+                {
+                    return LogicCacheError::CORRUPT_DATA;
+                }
+            }
+        }
+    }
+
+    std::function<YAML::Node(uint32_t)> buildNode = [&](uint32_t index) -> YAML::Node {
+        const CachedNode& node = nodes[index];
+        switch (node.type)
+        {
+        case CachedNodeType::SCALAR:
+            return YAML::Node(strings.substr(node.first, node.count));
+        case CachedNodeType::SEQUENCE:
+        {
+            YAML::Node sequence(YAML::NodeType::Sequence);
+            for (uint32_t i = node.first; i < node.first + node.count; i++)
+            {
+                sequence.push_back(buildNode(children[i]));
+            }
+            return sequence;
+        }
+        case CachedNodeType::MAP:
+        {
+            YAML::Node map(YAML::NodeType::Map);
+            for (uint32_t i = node.first; i < node.first + node.count * 2; i += 2)
+            {
+                map.force_insert(buildNode(children[i]), buildNode(children[i + 1]));
+            }
+            return map;
+        }
+        default:
+            return YAML::Node(YAML::NodeType::Null);
+        }
+    };
+
+    std::array<YAML::Node, NUM_TREES> trees;
+    for (size_t i = 0; i < NUM_TREES; i++)
+    {
+        if (header.roots[i] >= nodes.size())
+        {
+            return LogicCacheError::CORRUPT_DATA;
+        }
+        trees[i] = buildNode(header.roots[i]);
+    }
+
+    worldTemplate.worldData = trees[0];
+    worldTemplate.macros = trees[1];
+    worldTemplate.locationData = trees[2];
+    worldTemplate.itemData = trees[3];
+    worldTemplate.areaData = trees[4];
+    worldTemplate.dungeonEntranceInfo = trees[5];
+
+    return LogicCacheError::NONE;
+}
+
+LogicCacheError writeLogicCache(const fspath& cachePath, const WorldTemplate& worldTemplate)
+{
+    CacheHeader header;
+    if (worldTemplate.sourceHash.size() != sizeof(header.sourceHash))
+    {
+        return LogicCacheError::BAD_HEADER;
+    }
+    worldTemplate.sourceHash.copy(header.sourceHash, sizeof(header.sourceHash));
+
+    std::vector<CachedNode> nodes = {};
+    std::vector<uint32_t> children = {};
+    std::string strings = "";
+
+    // Write children before their parent so each node's children are contiguous
+    std::function<uint32_t(const YAML::Node&)> addNode = [&](const YAML::Node& yamlNode) -> uint32_t {
+        CachedNode node;
+        std::vector<uint32_t> nodeChildren = {};
+        switch (yamlNode.Type())
+        {
+        case YAML::NodeType::Scalar:
+            node.type = CachedNodeType::SCALAR;
+            node.first = strings.size();
+            node.count = yamlNode.Scalar().size();
+            strings += yamlNode.Scalar();
+            break;
+        case YAML::NodeType::Sequence:
+            node.type = CachedNodeType::SEQUENCE;
+            for (const auto& child : yamlNode)
+            {
+                nodeChildren.push_back(addNode(child));
+            }
+            node.count = nodeChildren.size();
+            break;
+        case YAML::NodeType::Map:
+            node.type = CachedNodeType::MAP;
+            for (const auto& child : yamlNode)
+            {
+                nodeChildren.push_back(addNode(child.first));
+                nodeChildren.push_back(addNode(child.second));
+            }
+            node.count = nodeChildren.size() / 2;
+            break;
+        default:
+            break;
+        }
+
+        if (!nodeChildren.empty())
+        {
+            node.first = children.size();
+            children.insert(children.end(), nodeChildren.begin(), nodeChildren.end());
+        }
+        nodes.push_back(node);
+        return nodes.size() - 1;
+    };
+
+    const auto trees = templateTrees(worldTemplate);
+    for (size_t i = 0; i < NUM_TREES; i++)
+    {
+        header.roots[i] = addNode(*trees[i]);
+    }
+    header.nodeCount = nodes.size();
+    header.childCount = children.size();
+    header.stringBytes = strings.size();
+
+    // Write to a temporary file first so a partially written cache is never picked up
+    fspath tempPath = cachePath;
+    tempPath += ".tmp";
+    {
+        std::ofstream file(tempPath, std::ios::binary);
+        if (!file.is_open())
+        {
+            return LogicCacheError::COULD_NOT_OPEN;
+        }
+
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.write(reinterpret_cast<const char*>(nodes.data()), nodes.size() * sizeof(CachedNode));
+        file.write(reinterpret_cast<const char*>(children.data()), children.size() * sizeof(uint32_t));
+        file.write(strings.data(), strings.size());
+        if (!file)
+        {
+            return LogicCacheError::COULD_NOT_WRITE;
+        }
+    }
+
+    std::error_code ec;
+    std::filesystem::rename(tempPath, cachePath, ec);
+    if (ec)
+    {
+        std::filesystem::remove(tempPath, ec);
+        return LogicCacheError::COULD_NOT_WRITE;
+    }
+
+    return LogicCacheError::NONE;
+}
+
+std::string errorGetName(LogicCacheError err)
+{
+    switch (err)
+    {
+    case LogicCacheError::NONE:
+        return "NONE";
+    case LogicCacheError::COULD_NOT_OPEN:
+        return "COULD_NOT_OPEN";
+    case LogicCacheError::COULD_NOT_WRITE:
+        return "COULD_NOT_WRITE";
+    case LogicCacheError::BAD_HEADER:
+        return "BAD_HEADER";
+    case LogicCacheError::HASH_MISMATCH:
+        return "HASH_MISMATCH";
+    case LogicCacheError::CORRUPT_DATA:
+        return "CORRUPT_DATA";
+    default:
+        return "UNKNOWN";
+    }
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include <utility/path.hpp>
+
+class WorldTemplate;
+
+// A binary copy of the parsed logic data files, so that later runs can skip
+// parsing the YAML. The cache is keyed by a hash of the source files and the
+// program version, and is only used when both match.
+//
+// Everything in the file is a fixed size record addressed by index, so it can
+// be read (or mapped) as a single block and walked without any parsing:
+//   header | nodes | child indices | string data
+enum struct [[nodiscard]] LogicCacheError
+{
+    NONE = 0,
+    COULD_NOT_OPEN,
+    COULD_NOT_WRITE,
+    BAD_HEADER,
+    HASH_MISMATCH,
+    CORRUPT_DATA,
+    COUNT
+};
+
+// Cache built at install time with --build-logic-cache, next to the logic files
+fspath getPrebuiltLogicCachePath();
+// Cache written on first run if there isn't a usable prebuilt one
+fspath getLogicCachePath();
+
+std::string logicCacheHash(const std::vector<std::string>& sourceFiles);
+LogicCacheError loadLogicCache(const fspath& cachePath, WorldTemplate& worldTemplate);
+LogicCacheError writeLogicCache(const fspath& cachePath, const WorldTemplate& worldTemplate);
+
+std::string errorGetName(LogicCacheError err);
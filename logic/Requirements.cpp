@@ -2,6 +2,7 @@
 #include "Requirements.hpp"
 
 #include <logic/GameItem.hpp>
+#include <logic/Inventory.hpp>
 #include <logic/PoolFunctions.hpp>
 #include <logic/World.hpp>
 #include <command/Log.hpp>
@@ -30,7 +31,7 @@ static const std::unordered_map<RequirementType, std::string> typeToNameMap = {
     {RequirementType::MACRO, "macro"},
 };
 
-bool evaluateRequirement(World* world, const Requirement& req, const ItemMultiSet* ownedItems, const EventSet* ownedEvents)
+bool evaluateRequirement(World* world, const Requirement& req, const Inventory* inventory)
 {
     uint32_t expectedCount = 0;
     uint32_t expectedHearts = 0;
@@ -50,7 +51,7 @@ bool evaluateRequirement(World* world, const Requirement& req, const ItemMultiSe
         return std::ranges::any_of(req.args
                                    ,
                                    [&](const Requirement::Argument& arg){
-                                       return evaluateRequirement(world, std::get<Requirement>(arg), ownedItems, ownedEvents);
+                                       return evaluateRequirement(world, std::get<Requirement>(arg), inventory);
                                    }
         );
 
@@ -58,35 +59,35 @@ bool evaluateRequirement(World* world, const Requirement& req, const ItemMultiSe
         return std::ranges::all_of(req.args
                                    ,
                                    [&](const Requirement::Argument& arg){
-                                       return evaluateRequirement(world, std::get<Requirement>(arg), ownedItems, ownedEvents);
+                                       return evaluateRequirement(world, std::get<Requirement>(arg), inventory);
                                    }
         );
 
     case RequirementType::HAS_ITEM:
         item = std::get<Item>(req.args[0]);
-        return ownedItems->contains(item);
+        return inventory->hasItem(item);
 
     case RequirementType::EVENT:
         event = std::get<EventId>(req.args[0]);
-        return ownedEvents->contains(event);
+        return inventory->hasEvent(world->getWorldId(), event);
 
     case RequirementType::COUNT:
         expectedCount = std::get<int>(req.args[0]);
         item = std::get<Item>(req.args[1]);
-        return ownedItems->count(item) >= expectedCount;
+        return inventory->itemCount(item) >= expectedCount;
 
     case RequirementType::HEALTH:
         expectedHearts = std::get<int>(req.args[0]);
-        totalHearts = ownedItems->count(Item(GameItem::HeartContainer, world)) +
+        totalHearts = inventory->itemCount(world->getWorldId(), GameItem::HeartContainer) +
                       world->getSettings().starting_hcs +
                       (world->getSettings().starting_pohs / 4);
         return totalHearts >= expectedHearts;
 
     case RequirementType::CAN_ACCESS:
-        return world->getArea(std::get<std::string>(req.args[0]))->isAccessible;
+        return world->areasByIndex[std::get<AreaIndex>(req.args[0])]->isAccessible;
 
     case RequirementType::MACRO:
-        return evaluateRequirement(world, world->macros[std::get<MacroIndex>(req.args[0])], ownedItems, ownedEvents);
+        return evaluateRequirement(world, world->macros[std::get<MacroIndex>(req.args[0])], inventory);
 
     case RequirementType::NONE:
     default:
@@ -96,6 +97,202 @@ bool evaluateRequirement(World* world, const Requirement& req, const ItemMultiSe
     return false;
 }
 
+// Lowers the requirement tree (and any macros it references) into a flat instruction list
+void RequirementProgram::compile(const Requirement& req, World* world_)
+{
+    world = world_;
+    worldId = world != nullptr ? world->getWorldId() : -1;
+    instructions.clear();
+    areas.clear();
+
+    emit(req);
+    threadJumps();
+}
+
+void RequirementProgram::emit(const Requirement& req)
+{
+    switch(req.type)
+    {
+    case RequirementType::NOTHING:
+        instructions.push_back({RequirementOp::SET_TRUE});
+        return;
+
+    case RequirementType::OR:
+    case RequirementType::AND:
+    {
+        // An empty "and" is true and an empty "or" is false, same as all_of/any_of
+        if (req.args.empty())
+        {
+            instructions.push_back({req.type == RequirementType::AND ? RequirementOp::SET_TRUE : RequirementOp::SET_FALSE});
+            return;
+        }
+
+        // After every argument except the last one, jump to the end of this
+        // requirement if its result already decides the outcome
+        const RequirementOp jumpOp = req.type == RequirementType::AND ? RequirementOp::JUMP_IF_FALSE : RequirementOp::JUMP_IF_TRUE;
+        std::vector<size_t> jumpsToPatch = {};
+        for (size_t i = 0; i < req.args.size(); i++)
+        {
+            emit(std::get<Requirement>(req.args[i]));
+            if (i + 1 < req.args.size())
+            {
+                jumpsToPatch.push_back(instructions.size());
+                instructions.push_back({jumpOp});
+            }
+        }
+        for (const auto& jump : jumpsToPatch)
+        {
+            instructions[jump].operand = instructions.size();
+        }
+        return;
+    }
+
+    case RequirementType::HAS_ITEM:
+    {
+        const Item& item = std::get<Item>(req.args[0]);
+        instructions.push_back({RequirementOp::HAS_ITEM, item.getGameItemId(), 0, static_cast<uint32_t>(item.getWorldId())});
+        return;
+    }
+
+    case RequirementType::EVENT:
+        instructions.push_back({RequirementOp::EVENT, GameItem::INVALID, 0, static_cast<uint32_t>(std::get<EventId>(req.args[0]))});
+        return;
+
+    case RequirementType::COUNT:
+    {
+        const Item& item = std::get<Item>(req.args[1]);
+        instructions.push_back({RequirementOp::COUNT, item.getGameItemId(), static_cast<uint16_t>(std::get<int>(req.args[0])), static_cast<uint32_t>(item.getWorldId())});
+        return;
+    }
+
+    case RequirementType::HEALTH:
+        instructions.push_back({RequirementOp::HEALTH, GameItem::HeartContainer, static_cast<uint16_t>(std::get<int>(req.args[0])), static_cast<uint32_t>(worldId)});
+        return;
+
+    case RequirementType::CAN_ACCESS:
+        instructions.push_back({RequirementOp::CAN_ACCESS, GameItem::INVALID, 0, static_cast<uint32_t>(areas.size())});
+        areas.push_back(world->areasByIndex[std::get<AreaIndex>(req.args[0])]);
+        return;
+
+    case RequirementType::MACRO:
+        emit(world->macros[std::get<MacroIndex>(req.args[0])]);
+        return;
+
+    case RequirementType::IMPOSSIBLE:
+    case RequirementType::NONE:
+    default:
+        instructions.push_back({RequirementOp::SET_FALSE});
+        return;
+    }
+}
+
+// Nested "and"s and "or"s leave chains of jumps at the end of each argument list.
+// Since jumps don't change the result, a jump that lands on another jump with the
+// same condition can go straight to that jump's target, and one that lands on a
+// jump with the opposite condition can skip over it.
+void RequirementProgram::threadJumps()
+{
+    auto isJump = [](const RequirementOp& op){ return op == RequirementOp::JUMP_IF_TRUE || op == RequirementOp::JUMP_IF_FALSE; };
+
+    for (auto& instruction : instructions)
+    {
+        if (!isJump(instruction.op))
+        {
+            continue;
+        }
+
+        auto target = instruction.operand;
+        while (target < instructions.size() && isJump(instructions[target].op))
+        {
+            target = instructions[target].op == instruction.op ? instructions[target].operand : target + 1;
+        }
+        instruction.operand = target;
+    }
+}
+
+bool RequirementProgram::evaluate(const Inventory* inventory) const
+{
+    bool result = false;
+    size_t pc = 0;
+    while (pc < instructions.size())
+    {
+        const RequirementInstruction& instruction = instructions[pc];
+        switch(instruction.op)
+        {
+        case RequirementOp::SET_TRUE:
+            result = true;
+            break;
+        case RequirementOp::SET_FALSE:
+            result = false;
+            break;
+        case RequirementOp::HAS_ITEM:
+            result = inventory->itemCount(instruction.operand, instruction.item) > 0;
+            break;
+        case RequirementOp::COUNT:
+            result = inventory->itemCount(instruction.operand, instruction.item) >= instruction.count;
+            break;
+        case RequirementOp::EVENT:
+            result = inventory->hasEvent(worldId, instruction.operand);
+            break;
+        case RequirementOp::HEALTH:
+            result = inventory->itemCount(instruction.operand, instruction.item) +
+                     world->getSettings().starting_hcs +
+                     (world->getSettings().starting_pohs / 4) >= instruction.count;
+            break;
+        case RequirementOp::CAN_ACCESS:
+        {
+            const Area* area = areas[instruction.operand];
+            result = inventory->tracksAreas() ? inventory->canAccess(area->world->getWorldId(), area->index) : area->isAccessible;
+            break;
+        }
+        case RequirementOp::JUMP_IF_TRUE:
+            if (result)
+            {
+                pc = instruction.operand;
+                continue;
+            }
+            break;
+        case RequirementOp::JUMP_IF_FALSE:
+            if (!result)
+            {
+                pc = instruction.operand;
+                continue;
+            }
+            break;
+        }
+        pc++;
+    }
+    return result;
+}
+
+size_t RequirementProgram::size() const
+{
+    return instructions.size();
+}
+
+void RequirementProgram::forEachDependency(const std::function<void(int, GameItem)>& onItem, const std::function<void(int, EventId)>& onEvent, const std::function<void(Area*)>& onArea) const
+{
+    for (const auto& instruction : instructions)
+    {
+        switch(instruction.op)
+        {
+        case RequirementOp::HAS_ITEM:
+        case RequirementOp::COUNT:
+        case RequirementOp::HEALTH:
+            onItem(instruction.operand, instruction.item);
+            break;
+        case RequirementOp::EVENT:
+            onEvent(worldId, instruction.operand);
+            break;
+        case RequirementOp::CAN_ACCESS:
+            onArea(areas[instruction.operand]);
+            break;
+        default:
+            break;
+        }
+    }
+}
+
 static std::string tabs(int numTabs)
 {
     return std::string(numTabs, '\t');
@@ -170,7 +367,7 @@ std::string printRequirement(const Requirement& req, World* world, int nestingLe
         returnStr += item.getName() + " x" + std::to_string(expectedCount);
         return returnStr;
     case RequirementType::CAN_ACCESS:
-        returnStr += "can_access: " + std::get<std::string>(req.args[0]);
+        returnStr += "can_access: " + world->areasByIndex[std::get<AreaIndex>(req.args[0])]->name;
         return returnStr;
     case RequirementType::SETTING:
         // Settings are resolved to a true/false value when building the world
@@ -307,7 +504,7 @@ RequirementError parseRequirementString(const std::string& str, Requirement& req
             req.type = RequirementType::CAN_ACCESS;
             std::string areaName (argStr.begin() + argStr.find('(') + 1, argStr.end() - 1);
             auto area = world->getArea(areaName);
-            req.args.emplace_back(area->name);
+            req.args.emplace_back(static_cast<AreaIndex>(area->index));
             return RequirementError::NONE;
         }
         // Then a setting...
@@ -1,6 +1,8 @@
 
 #pragma once
 
+#include <cstdint>
+#include <functional>
 #include <string>
 #include <vector>
 #include <variant>
@@ -9,6 +11,8 @@
 #include <logic/GameItem.hpp>
 
 class World;
+class Area;
+class Inventory;
 enum struct RequirementType
 {
     NONE = 0,
@@ -39,9 +43,8 @@ enum struct RequirementError
 };
 
 using MacroIndex = size_t;
+using AreaIndex = size_t;
 using EventId = size_t;
-using ItemMultiSet = std::unordered_multiset<Item>;
-using EventSet = std::unordered_set<EventId>;
 
 struct Requirement
 {
@@ -54,7 +57,55 @@ struct Requirement
     std::unordered_set<GameItem> getItems(World* world) const;
 };
 
-bool evaluateRequirement(World* world, const Requirement& req, const ItemMultiSet* ownedItems, const EventSet* ownedEvents);
+// A Requirement lowered into a flat list of instructions. Macros are inlined and
+// can_access checks are resolved to their areas at compile time, so evaluating
+// the program is a single loop over a contiguous array instead of a recursive
+// walk through nested variants. All instructions write to one boolean result
+// register, and "and"/"or" nodes become conditional jumps over the rest of their
+// arguments so evaluation still short-circuits.
+enum struct RequirementOp : uint8_t
+{
+    SET_TRUE = 0,
+    SET_FALSE,
+    HAS_ITEM,
+    COUNT,
+    EVENT,
+    HEALTH,
+    CAN_ACCESS,
+    JUMP_IF_TRUE,
+    JUMP_IF_FALSE,
+};
+
+struct RequirementInstruction
+{
+    RequirementOp op = RequirementOp::SET_FALSE;
+    GameItem item = GameItem::INVALID; // item for HAS_ITEM, COUNT and HEALTH
+    uint16_t count = 0;   // expected count for COUNT and HEALTH
+    uint32_t operand = 0; // world id of the item, event id, area table index, or jump target
+};
+
+class RequirementProgram
+{
+public:
+    void compile(const Requirement& req, World* world);
+    bool evaluate(const Inventory* inventory) const;
+    size_t size() const;
+
+    // Calls the matching function for every item, event and area this program
+    // reads. Used for building reverse dependency indices for incremental searching
+    void forEachDependency(const std::function<void(int, GameItem)>& onItem, const std::function<void(int, EventId)>& onEvent, const std::function<void(Area*)>& onArea) const;
+
+private:
+    void emit(const Requirement& req);
+    void threadJumps();
+
+    std::vector<RequirementInstruction> instructions = {};
+    std::vector<Area*> areas = {};
+    World* world = nullptr;
+    int worldId = -1;
+};
+
+bool evaluateRequirement(World* world, const Requirement& req, const Inventory* inventory);
 std::string printRequirement(const Requirement& req, World* world, int nestingLevel = 0);
 RequirementError parseRequirementString(const std::string& str, Requirement& req, World* world);
 std::string errorToName(const RequirementError& err);
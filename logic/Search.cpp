@@ -1,16 +1,20 @@
 
 #include "Search.hpp"
 
+#include <cassert>
 #include <list>
 #include <ranges>
 #include <unordered_set>
 #include <algorithm>
 
+#include <logic/Inventory.hpp>
+#include <logic/IncrementalSearch.hpp>
+#include <logic/Fill.hpp>
 #include <logic/PoolFunctions.hpp>
 #include <command/Log.hpp>
 
 // Recursively explore new areas based on the given areaEntry
-void explore(const SearchMode& searchMode, WorldPool& worlds, const ItemMultiSet& ownedItems, const EventSet& ownedEvents, Area* area, std::list<EventAccess*>& eventsToTry, std::list<Entrance*>& exitsToTry, std::list<LocationAccess*>& locationsToTry, bool tracker)
+void explore(const SearchMode& searchMode, WorldPool& worlds, const Inventory& inventory, Area* area, std::list<EventAccess*>& eventsToTry, std::list<Entrance*>& exitsToTry, std::list<LocationAccess*>& locationsToTry, bool tracker)
 {
     for (auto& eventAccess : area->events)
     {
@@ -48,7 +52,7 @@ void explore(const SearchMode& searchMode, WorldPool& worlds, const ItemMultiSet
                 }
             }
 
-            if (!reverseInPlaythrough && evaluateRequirement(exit.getWorld(), exit.getRequirement(), &ownedItems, &ownedEvents))
+            if (!reverseInPlaythrough && exit.getRequirementProgram().evaluate(&inventory))
             {
                 worlds[0].entranceSpheres.back().push_back(&exit);
             }
@@ -59,11 +63,11 @@ void explore(const SearchMode& searchMode, WorldPool& worlds, const ItemMultiSet
         // is ignored since it won't matter for logical access
         if (!connectedArea->isAccessible)
         {
-            if (evaluateRequirement(exit.getWorld(), exit.getRequirement(), &ownedItems, &ownedEvents))
+            if (exit.getRequirementProgram().evaluate(&inventory))
             {
                 exit.setFound(true);
                 connectedArea->isAccessible = true;
-                explore(searchMode, worlds, ownedItems, ownedEvents, connectedArea, eventsToTry, exitsToTry, locationsToTry, tracker);
+                explore(searchMode, worlds, inventory, connectedArea, eventsToTry, exitsToTry, locationsToTry, tracker);
             }
             else
             {
@@ -81,57 +85,225 @@ void explore(const SearchMode& searchMode, WorldPool& worlds, const ItemMultiSet
     }
 }
 
-// Argument 2 is a copy of the passed in ItemPool since we want to modify
-// it locally. If worldToSearch is not -1 then only the world with that worldId
-// will be searched.
-LocationPool search(const SearchMode& searchMode, WorldPool& worlds, ItemPool items, int worldToSearch /* = -1 */, bool tracker /*= false*/)
+// The events, exits and locations a search hasn't reached yet. Anything whose
+// requirement returned false stays here to be tried again on the next sphere
+struct SearchFrontier
 {
-    // Add starting inventory items to the pool of items
-    for (auto& world : worlds)
+    std::list<EventAccess*> eventsToTry = {};
+    std::list<Entrance*> exitsToTry = {};
+    std::list<LocationAccess*> locationsToTry = {};
+};
+
+// Reset the world's search variables. If the world is being searched, its
+// root exits are put on the frontier to start from
+static void startSearch(World& world, int worldToSearch, SearchFrontier& frontier)
+{
+    assert(world.logicRequirementsAreCompiled());
+
+    if (worldToSearch == -1 || worldToSearch == world.getWorldId())
     {
-        if (worldToSearch == -1 || worldToSearch == world.getWorldId())
+        for (auto& exit : world.root->exits)
         {
-            addElementsToPool(items, world.getStartingItems());
+            frontier.exitsToTry.push_back(&exit);
         }
     }
 
-    ItemMultiSet ownedItems (items.begin(), items.end());
-    EventSet ownedEvents = {};
+    // Reset search variables for all areas and exits
+    for (const auto area : world.areasByIndex)
+    {
+        area->isAccessible = false;
+    }
+    for (const auto exit : world.entrancesByIndex)
+    {
+        if (exit != nullptr)
+        {
+            exit->setFound(false);
+        }
+    }
 
-    LocationPool accessibleLocations = {};
-    // Lists of events, exits and locations whose requirement returned false.
-    // These will be tried and explored on the next iteration. Start
-    // by putting the root exit of each world into the list of exits
-    // to try (or only the exit of the single world to explore).
-    std::list<EventAccess*> eventsToTry = {};
-    std::list<Entrance*> exitsToTry = {};
-    std::list<LocationAccess*> locationsToTry = {};
-    for (auto& world : worlds)
+    for (const auto location : world.locationsByIndex)
     {
-        if (worldToSearch == -1 || worldToSearch == world.getWorldId())
+        location->hasBeenFound = false;
+    }
+}
+
+// Reach everything on the frontier that's accessible with the current inventory
+// for one sphere. Events found are added to the inventory, but the items at the
+// newly accessible locations aren't; they're put in accessibleThisIteration.
+// Returns whether anything new was found
+static bool searchSphere(const SearchMode& searchMode, WorldPool& worlds, Inventory& inventory, SearchFrontier& frontier, LocationPool& accessibleThisIteration, bool tracker)
+{
+    auto& [eventsToTry, exitsToTry, locationsToTry] = frontier;
+
+    // Variable to keep track of making logical progress. We want to keep
+    // looping as long as we're finding new things on each iteration
+    bool newThingsFound = false;
+    // Loop through and see if there are any events that we are now accessible.
+    // Add them to the inventory if they are.
+    std::set<std::pair<int, EventId>> accessibleEvents = {};
+    bool newEventsOrExits = false;
+    // Continuously loop through events and exits until no new events or exits are
+    // found. Since they can unlock each other, this is necessary for proper sphere calculations
+    do
+    {
+        newEventsOrExits = false;
+        for (auto eventItr = eventsToTry.begin(); eventItr != eventsToTry.end(); )
         {
-            for (auto& exit : world.getArea("Root")->exits)
+            auto eventAccess = *eventItr;
+            auto event = eventAccess->event;
+            auto worldId = eventAccess->world->getWorldId();
+            if (inventory.hasEvent(worldId, event) || accessibleEvents.contains({worldId, event}))
+            {
+                eventItr = eventsToTry.erase(eventItr);
+                continue;
+            }
+            if (eventAccess->program.evaluate(&inventory))
+            {
+                newThingsFound = true;
+                newEventsOrExits = true;
+                eventItr = eventsToTry.erase(eventItr);
+                // If we're generating the playthrough, add it to the eventSpheres
+                if (searchMode == SearchMode::GeneratePlaythrough && eventAccess->world->isSphereEvent(event))
+                {
+                    worlds[0].eventSpheres.back().push_back(eventAccess);
+                    accessibleEvents.insert({worldId, event});
+                }
+                else
+                {
+                    inventory.addEvent(worldId, event);
+                }
+            }
+            else
             {
-                exitsToTry.push_back(&exit);
+                eventItr++; // Only increment if we don't erase
             }
         }
 
-        // Reset search variables for all areas and exits
-        for (auto& [name, area] : world.areaTable)
+        // Search each exit in the exitsToTry list and explore any new areas found as well.
+        // For any exits which we try and don't meet the requirements for, put them
+        // into exitsToTry for the next iteration. Any locations we come across will
+        // be added to locationsToTry.
+        for (auto exitItr = exitsToTry.begin(); exitItr != exitsToTry.end(); )
         {
-            area->isAccessible = false;
-            for (auto& exit : area->exits)
+            auto exit = *exitItr;
+            if (exit->getRequirementProgram().evaluate(&inventory)) {
+                exit->setFound(true);
+                // Erase the exit from the list of exits if we've met its requirement
+                exitItr = exitsToTry.erase(exitItr);
+                if (exit->getConnectedArea() == nullptr)
+                {
+                    continue;
+                }
+                // If we're generating the playthrough, add it to the entranceSpheres if it's randomized
+                if (searchMode == SearchMode::GeneratePlaythrough && exit->isShuffled())
+                {
+                    worlds[0].entranceSpheres.back().push_back(exit);
+                }
+                // If this exit's connected region has not been explored yet, then explore it
+                auto connectedArea = exit->getConnectedArea();
+                if (!connectedArea->isAccessible)
+                {
+                    newThingsFound = true;
+                    newEventsOrExits = true;
+                    connectedArea->isAccessible = true;
+                    explore(searchMode, worlds, inventory, connectedArea, eventsToTry, exitsToTry, locationsToTry, tracker);
+                }
+            }
+            else
             {
-                exit.setFound(false);
+                exitItr++; // Only increment if we don't erase
             }
         }
+    } while (newEventsOrExits);
+    
 
-        for (auto& [name, location] : world.locationTable)
+
+    // Note which locations are now accessible on this iteration
+    for (auto locItr = locationsToTry.begin(); locItr != locationsToTry.end(); )
+    {
+        auto locAccess = *locItr;
+        auto location = locAccess->location;
+        // Erase locations which have already been found. Some item locations
+        // can be obtained from multiple areas, so this check is necessary
+        // in those circumstances
+        if (location->hasBeenFound)
+        {
+            locItr = locationsToTry.erase(locItr);
+            continue;
+        }
+        if (locAccess->program.evaluate(&inventory))
+        {
+            newThingsFound = true;
+            location->hasBeenFound = true;
+            // Delete newly accessible locations from the list
+            accessibleThisIteration.push_back(location);
+            locItr = locationsToTry.erase(locItr);
+        }
+        else
+        {
+            locItr++; // Only increment if we don't erase
+        }
+    }
+
+    // Add events from this sphere to the inventory
+    for (auto& [worldId, event] : accessibleEvents)
+    {
+        inventory.addEvent(worldId, event);
+    }
+
+    return newThingsFound;
+}
+
+// Apply the effects of a newly accessible location for the next sphere. Returns
+// whether the location's item was added to the inventory
+static bool collectLocation(const SearchMode& searchMode, WorldPool& worlds, Inventory& inventory, Location* location, LocationPool& accessibleLocations, const LocationMask* allowedLocations)
+{
+    if (allowedLocations == nullptr || (allowedLocations->contains(location) && location->currentItem.getGameItemId() == GameItem::INVALID))
+    {
+        accessibleLocations.push_back(location);
+    }
+    const Item& item = location->currentItem; 
+    if (item.getGameItemId() != GameItem::INVALID && !item.isJunkItem())
+    {
+        inventory.addItem(item);
+        // Only add progression locations to the playthrough if they don't have known vanilla items
+        // Also add in dungeon locations which have small/big keys if mixed bosses is on
+        if (searchMode == SearchMode::GeneratePlaythrough && ((location->progression && (!location->hasKnownVanillaItem || item.getGameItemId() == GameItem::GameBeatable)) ||
+                                                              (location->world->getSettings().mix_bosses && (item.isBigKey() || item.isSmallKey()))))
+        {
+            worlds[0].playthroughSpheres.back().push_back(location);
+        }
+        return true;
+    }
+    return false;
+}
+
+// Argument 2 is a copy of the passed in ItemPool since we want to modify
+// it locally. If worldToSearch is not -1 then only the world with that worldId
+// will be searched. If allowedLocations is given, only the empty locations within
+// it are returned, although every location is still searched.
+static LocationPool search(const SearchMode& searchMode, WorldPool& worlds, ItemPool items, int worldToSearch, bool tracker, const LocationMask* allowedLocations)
+{
+    // Add starting inventory items to the pool of items
+    for (auto& world : worlds)
+    {
+        if (worldToSearch == -1 || worldToSearch == world.getWorldId())
         {
-            location->hasBeenFound = false;
+            addElementsToPool(items, world.getStartingItems());
         }
     }
 
+    Inventory inventory (items);
+
+    LocationPool accessibleLocations = {};
+    // Start by putting the root exit of each world into the list of exits
+    // to try (or only the exit of the single world to explore).
+    SearchFrontier frontier = {};
+    for (auto& world : worlds)
+    {
+        startSearch(world, worldToSearch, frontier);
+    }
+
     // Variables for general searching
     bool newThingsFound = false;
 
@@ -145,163 +317,121 @@ LocationPool search(const SearchMode& searchMode, WorldPool& worlds, ItemPool it
             worlds[0].entranceSpheres.emplace_back();
         }
 
-        // Variable to keep track of making logical progress. We want to keep
-        // looping as long as we're finding new things on each iteration
-        newThingsFound = false;
-        // Loop through and see if there are any events that we are now accessible.
-        // Add them to the ownedEvents list if they are.
-        std::set<EventId> accessibleEvents = {};
-        bool newEventsOrExits = false;
-        // Continuously loop through events and exits until no new events or exits are
-        // found. Since they can unlock each other, this is necessary for proper sphere calculations
-        do
+        LocationPool accessibleThisIteration = {};
+        newThingsFound = searchSphere(searchMode, worlds, inventory, frontier, accessibleThisIteration, tracker);
+
+        // Now apply any effects of newly accessible locations for the next iteration.
+        // This lets us properly keep track of spheres for playthrough generation
+        for (auto location : accessibleThisIteration)
         {
-            newEventsOrExits = false;
-            for (auto eventItr = eventsToTry.begin(); eventItr != eventsToTry.end(); )
-            {
-                auto eventAccess = *eventItr;
-                auto event = eventAccess->event;
-                if (ownedEvents.contains(event) || accessibleEvents.contains(event))
-                {
-                    eventItr = eventsToTry.erase(eventItr);
-                    continue;
-                }
-                if (evaluateRequirement(eventAccess->world, eventAccess->requirement, &ownedItems, &ownedEvents))
-                {
-                    newThingsFound = true;
-                    newEventsOrExits = true;
-                    eventItr = eventsToTry.erase(eventItr);
-                    // If we're generating the playthrough, add it to the eventSpheres
-                    if (searchMode == SearchMode::GeneratePlaythrough && eventAccess->world->isSphereEvent(event))
-                    {
-                        worlds[0].eventSpheres.back().push_back(event);
-                        accessibleEvents.insert(event);
-                    }
-                    else
-                    {
-                        ownedEvents.insert(event);
-                    }
-                }
-                else
-                {
-                    eventItr++; // Only increment if we don't erase
-                }
-            }
+            collectLocation(searchMode, worlds, inventory, location, accessibleLocations, allowedLocations);
+        }
+    }
+    while (newThingsFound);
 
-            // Search each exit in the exitsToTry list and explore any new areas found as well.
-            // For any exits which we try and don't meet the requirements for, put them
-            // into exitsToTry for the next iteration. Any locations we come across will
-            // be added to locationsToTry.
-            for (auto exitItr = exitsToTry.begin(); exitItr != exitsToTry.end(); )
-            {
-                auto exit = *exitItr;
-                if (evaluateRequirement(exit->getWorld(), exit->getRequirement(), &ownedItems, &ownedEvents)) {
-                    exit->setFound(true);
-                    // Erase the exit from the list of exits if we've met its requirement
-                    exitItr = exitsToTry.erase(exitItr);
-                    if (exit->getConnectedArea() == nullptr)
-                    {
-                        continue;
-                    }
-                    // If we're generating the playthrough, add it to the entranceSpheres if it's randomized
-                    if (searchMode == SearchMode::GeneratePlaythrough && exit->isShuffled())
-                    {
-                        worlds[0].entranceSpheres.back().push_back(exit);
-                    }
-                    // If this exit's connected region has not been explored yet, then explore it
-                    auto connectedArea = exit->getConnectedArea();
-                    if (!connectedArea->isAccessible)
-                    {
-                        newThingsFound = true;
-                        newEventsOrExits = true;
-                        connectedArea->isAccessible = true;
-                        explore(searchMode, worlds, ownedItems, ownedEvents, connectedArea, eventsToTry, exitsToTry, locationsToTry, tracker);
-                    }
-                }
-                else
-                {
-                    exitItr++; // Only increment if we don't erase
-                }
-            }
-        } while (newEventsOrExits);
-        
+    return accessibleLocations;
+}
+
+// Same as the search above, except each world keeps its own frontier. Worlds
+// only affect each other through the items they find, so after the first sphere
+// only the worlds which were given new items are searched again, and the worlds
+// searched in a sphere are searched in parallel. Locations are returned grouped
+// by world instead of in the order they were found, so this is only used for
+// checks which don't depend on that order
+static LocationPool searchEachWorld(const SearchMode& searchMode, WorldPool& worlds, ItemPool items, int worldToSearch)
+{
+    for (auto& world : worlds)
+    {
+        if (worldToSearch == -1 || worldToSearch == world.getWorldId())
+        {
+            addElementsToPool(items, world.getStartingItems());
+        }
+    }
 
+    Inventory inventory (items);
+    inventory.reserveWorlds(worlds.size());
 
-        // Note which locations are now accessible on this iteration
-        LocationPool accessibleThisIteration = {};
-        for (auto locItr = locationsToTry.begin(); locItr != locationsToTry.end(); )
+    LocationPool accessibleLocations = {};
+    std::vector<SearchFrontier> frontiers (worlds.size());
+    std::vector<LocationPool> accessibleThisIteration (worlds.size());
+    for (auto& world : worlds)
+    {
+        startSearch(world, worldToSearch, frontiers[world.getWorldId()]);
+    }
+
+    std::vector<char> worldsToSearch (worlds.size(), true);
+    std::vector<int> searching = {};
+    while (true)
+    {
+        searching.clear();
+        for (size_t i = 0; i < worlds.size(); i++)
         {
-            auto locAccess = *locItr;
-            auto location = locAccess->location;
-            // Erase locations which have already been found. Some item locations
-            // can be obtained from multiple areas, so this check is necessary
-            // in those circumstances
-            if (location->hasBeenFound)
-            {
-                locItr = locationsToTry.erase(locItr);
-                continue;
-            }
-            if (evaluateRequirement(location->world, locAccess->requirement, &ownedItems, &ownedEvents))
-            {
-                newThingsFound = true;
-                location->hasBeenFound = true;
-                // Delete newly accessible locations from the list
-                accessibleThisIteration.push_back(location);
-                locItr = locationsToTry.erase(locItr);
-            }
-            else
+            if (worldsToSearch[i])
             {
-                locItr++; // Only increment if we don't erase
+                searching.push_back(i);
             }
         }
-
-        // Add events from this sphere to ownedEvents
-        for (auto event : accessibleEvents)
+        if (searching.empty())
         {
-            ownedEvents.insert(event);
+            break;
         }
 
-        // Now apply any effects of newly accessible locations for the next iteration.
-        // This lets us properly keep track of spheres for playthrough generation
-        for (auto location : accessibleThisIteration)
+        // Each world only reaches its own areas and events, so worlds can be
+        // searched at the same time while nobody adds items to the inventory
+        const size_t numThreads = getFillThreadCount(searching.size());
+        runOnFillThreads(numThreads, [&](const size_t& first){
+            for (size_t i = first; i < searching.size(); i += numThreads)
+            {
+                const int worldId = searching[i];
+                searchSphere(searchMode, worlds, inventory, frontiers[worldId], accessibleThisIteration[worldId], false);
+            }
+        });
+
+        // Give out the items found this sphere and only search the worlds which
+        // got something new on the next one
+        std::ranges::fill(worldsToSearch, false);
+        for (const auto& worldId : searching)
         {
-            accessibleLocations.push_back(location);
-            const Item& item = location->currentItem; 
-            if (item.getGameItemId() != GameItem::INVALID && !item.isJunkItem())
+            for (auto location : accessibleThisIteration[worldId])
             {
-                ownedItems.emplace(item);
-                // Only add progression locations to the playthrough if they don't have known vanilla items
-                // Also add in dungeon locations which have small/big keys if mixed bosses is on
-                if (searchMode == SearchMode::GeneratePlaythrough && ((location->progression && (!location->hasKnownVanillaItem || item.getGameItemId() == GameItem::GameBeatable)) ||
-                                                                      (location->world->getSettings().mix_bosses && (item.isBigKey() || item.isSmallKey()))))
+                if (collectLocation(searchMode, worlds, inventory, location, accessibleLocations, nullptr))
                 {
-                    worlds[0].playthroughSpheres.back().push_back(location);
+                    worldsToSearch[location->currentItem.getWorldId()] = true;
                 }
             }
+            accessibleThisIteration[worldId].clear();
         }
     }
-    while (newThingsFound);
 
     return accessibleLocations;
 }
 
+LocationPool search(const SearchMode& searchMode, WorldPool& worlds, ItemPool items, int worldToSearch /* = -1 */, bool tracker /*= false*/)
+{
+    return search(searchMode, worlds, std::move(items), worldToSearch, tracker, nullptr);
+}
+
 LocationPool getAccessibleLocations(WorldPool& worlds, ItemPool& items, LocationPool& allowedLocations, int worldToSearch /*= -1*/, bool tracker /*= false*/)
 {
-    auto accessibleLocations = search(SearchMode::AccessibleLocations, worlds, items, worldToSearch, tracker);
-    // Filter to only those locations which are allowed
-    return filterFromPool(accessibleLocations, [allowedLocations](Location* loc){return elementInPool(loc, allowedLocations) && loc->currentItem.getGameItemId() == GameItem::INVALID;});
+    return getAccessibleLocations(worlds, items, LocationMask(allowedLocations), worldToSearch, tracker);
+}
+
+// Returns the accessible locations which are allowed and don't have an item yet
+LocationPool getAccessibleLocations(WorldPool& worlds, ItemPool& items, const LocationMask& allowedLocations, int worldToSearch /*= -1*/, bool tracker /*= false*/)
+{
+    return search(SearchMode::AccessibleLocations, worlds, items, worldToSearch, tracker, &allowedLocations);
 }
 
 void runGeneralSearch(WorldPool& worlds, int worldToSearch /*= -1*/)
 {
     ItemPool emptyItems = {};
-    search(SearchMode::AccessibleLocations, worlds, emptyItems, worldToSearch);
+    searchEachWorld(SearchMode::AccessibleLocations, worlds, emptyItems, worldToSearch);
 }
 
 bool gameBeatable(WorldPool& worlds)
 {
     ItemPool emptyItems = {};
-    auto accessibleLocations = search(SearchMode::GameBeatable, worlds, emptyItems);
+    auto accessibleLocations = searchEachWorld(SearchMode::GameBeatable, worlds, emptyItems, -1);
     auto worldsBeatable = filterFromPool(accessibleLocations, [](Location* loc){return loc->currentItem.getGameItemId() == GameItem::GameBeatable;});
     return worldsBeatable.size() == worlds.size();
 }
@@ -333,6 +463,9 @@ static void pareDownPlaythrough(WorldPool& worlds)
         }
     }
 
+    // Only one location's item is taken away at a time, so update the same
+    // search for each of them instead of searching from scratch
+    IncrementalSearch beatableSearch (worlds);
     for (auto& sphere : playthroughSpheres)
     {
         for (auto locIt = sphere.begin(); locIt != sphere.end(); )
@@ -341,7 +474,8 @@ static void pareDownPlaythrough(WorldPool& worlds)
             auto location = *locIt;
             const Item itemAtLocation = location->currentItem;
             location->currentItem = {GameItem::INVALID, location->world};
-            if (gameBeatable(worlds))
+            beatableSearch.updateLocation(location);
+            if (beatableSearch.gameBeatable())
             {
                 // If the game is still beatable, then this location is not required
                 // and we can erase it from the playthrough
@@ -351,6 +485,7 @@ static void pareDownPlaythrough(WorldPool& worlds)
             else
             {
                 location->currentItem = itemAtLocation;
+                beatableSearch.updateLocation(location);
                 locIt++; // Only increment if we don't erase
             }
         }
@@ -370,8 +505,10 @@ static void pareDownPlaythrough(WorldPool& worlds)
         location->currentItem = item;
     }
 
-    // Now do the same process for the entrances to pare down the entrance playthrough
-    std::unordered_map<Entrance*, Area*> nonRequiredEntrances = {};
+    // Now do the same process for the entrances to pare down the entrance playthrough.
+    // Non-required entrances are reconnected in the order they were found so that
+    // the order of each area's entrances doesn't depend on where things are in memory
+    std::list<std::pair<Entrance*, Area*>> nonRequiredEntrances = {};
     for (std::list<Entrance*>& entranceSphere : std::ranges::reverse_view(entranceSpheres))
     {
         for (auto entranceItr = entranceSphere.begin(); entranceItr != entranceSphere.end(); )
@@ -384,7 +521,7 @@ static void pareDownPlaythrough(WorldPool& worlds)
                 // If the game is still beatable, then this entrance is not required
                 // and we can erase it from the playthrough
                 entranceItr = entranceSphere.erase(entranceItr);
-                nonRequiredEntrances[entrance] = connectedArea;
+                nonRequiredEntrances.emplace_back(entrance, connectedArea);
             }
             else
             {
@@ -435,7 +572,7 @@ void generatePlaythrough(WorldPool& worlds)
 // Checks to see if the specific locations from the passed in location pool are all accessible
 bool locationsReachable(WorldPool& worlds, ItemPool& items, LocationPool& locationsToCheck, int worldToSearch /*= -1*/)
 {
-    auto accessibleLocations = search(SearchMode::AccessibleLocations, worlds, items, worldToSearch);
+    auto accessibleLocations = searchEachWorld(SearchMode::AccessibleLocations, worlds, items, worldToSearch);
     // Check if every location in locationsToCheck is in accessibleLocations
     return std::ranges::all_of(locationsToCheck, [&](const Location* loc){
         bool inPool = elementInPool(loc, accessibleLocations);
@@ -455,6 +592,6 @@ bool allLocationsReachable(WorldPool& worlds, ItemPool& items, int worldToSearch
     {
         totalWorldsLocations += world.locationTable.size();
     }
-    auto accessibleLocations = search(SearchMode::AllLocationsReachable, worlds, items, worldToSearch);
+    auto accessibleLocations = searchEachWorld(SearchMode::AllLocationsReachable, worlds, items, worldToSearch);
     return totalWorldsLocations == accessibleLocations.size();
 }
@@ -165,9 +165,9 @@ void generateSpoilerLog(WorldPool& worlds)
         {
             spoilerLog << "        " << getSpoilerFormatLocation(location, longestNameLength, worlds) << std::endl;
         }
-        for (auto event : sphereEvents)
+        for (auto eventAccess : sphereEvents)
         {
-            spoilerLog << "        " << worlds[0].reverseEventMap[event] << std::endl;
+            spoilerLog << "        " << eventAccess->world->reverseEventMap[eventAccess->event] << std::endl;
         }
     }
     spoilerLog << std::endl;
@@ -11,6 +11,7 @@
 #include <logic/PoolFunctions.hpp>
 #include <logic/Search.hpp>
 #include <logic/flatten/flatten.hpp>
+#include <logic/WorldTemplate.hpp>
 #include <command/Log.hpp>
 #include <utility/platform.hpp>
 #include <utility/string.hpp>
@@ -18,7 +19,7 @@
 #include <seedgen/random.hpp>
 #include <options.hpp>
 
-static std::stringstream lastError;
+static thread_local std::stringstream lastError;
 
 // some error checking macros for brevity and since we can't use exceptions
 #define YAML_FIELD_CHECK(ref, key, err) if(!ref[key]) {lastError << "Unable to find key: \"" << key << '"'; return err;}
@@ -29,8 +30,6 @@ static std::stringstream lastError;
 #define LOCATION_VALID_CHECK(loc, msg) VALID_CHECK(locationTable.contains(loc), false, msg, WorldLoadingError::LOCATION_DOES_NOT_EXIST)
 #define VALID_DUNGEON_CHECK(dungeon) if (!isValidDungeon(dungeon)) {ErrorLog::getInstance().log("Unrecognized dungeon name: \"" + dungeon + "\""); LOG_ERR_AND_RETURN(WorldLoadingError::INVALID_DUNGEON_NAME)};
 
-int World::eventCounter = 0;
-
 // Potentially set different settings for different worlds
 void World::setSettings(const Settings& settings_)
 {
@@ -243,6 +242,14 @@ Area* World::getArea(const std::string& area)
 }
 
 void World::remapChart(GameItem chart, uint8_t islandNum)
+{
+    setChartMacro(chart, islandNum);
+    compileLogicRequirements();
+}
+
+// Point the island's chart macro at the given chart without recompiling anything,
+// so several charts can be changed before compiling once
+void World::setChartMacro(GameItem chart, uint8_t islandNum)
 {
     chartMappings[islandNum] = chart;
     // Clear the original macro
@@ -267,6 +274,7 @@ void World::remapChart(GameItem chart, uint8_t islandNum)
 
     // Set the new requirement
     parseRequirementString(reqStr, chartMacro, this);
+    logicRequirementsCompiled = false;
 }
 
 void World::determineChartMappings()
@@ -294,9 +302,10 @@ void World::determineChartMappings()
         // Change the macro for this island's chart to the one at this index in the array.
         const std::string chartName = gameItemToName(chart);
         LOG_TO_DEBUG("\tChart for Island " + std::to_string(sector) + " is now " + chartName);
-        remapChart(chart, sector);
+        setChartMacro(chart, sector);
     }
     LOG_TO_DEBUG("]");
+    compileLogicRequirements();
 }
 
 // Returns whether or not the sunken treasure location has a treasure/triforce chart leading to it
@@ -652,6 +661,7 @@ World::WorldLoadingError World::reparseMacro(const std::string& macroName)
         lastError << " | Encountered reparsing macro of name " << macroName;
         return WorldLoadingError::BAD_REQUIREMENT;
     }
+    compileLogicRequirements();
 
     return WorldLoadingError::NONE;
 }
@@ -664,7 +674,7 @@ World::WorldLoadingError World::loadLocation(const YAML::Node& locationObject)
     addLocation(locationName);
     Location* location = locationTable[locationName].get();
     // Sort locations by order of processing
-    static int sortPriority = 0;
+    static thread_local int sortPriority = 0;
     location->sortPriority = sortPriority++;
     location->world = this;
     location->plandomized = false;
@@ -1104,14 +1114,8 @@ World::WorldLoadingError World::loadAreaTranslations(const YAML::Node& areaObjec
     return WorldLoadingError::NONE;
 }
 
-World::WorldLoadingError World::loadDungeonExitInfo()
+World::WorldLoadingError World::loadDungeonExitInfo(const YAML::Node& dungeonExitTree)
 {
-    YAML::Node dungeonExitTree;
-    if(!LoadYAML(dungeonExitTree, Utility::get_data_path() / "logic/dungeon_entrance_info.yaml", true)) {
-        ErrorLog::getInstance().log("Could not load dungeon_entrance_info.yaml");
-        return WorldLoadingError::DATA_FILE_ERROR;
-    }
-
     for (const auto& dungeonExitData : dungeonExitTree)
     {
         auto dungeonName = dungeonExitData.first.as<std::string>();
@@ -1184,14 +1188,21 @@ World::WorldLoadingError World::processPlandomizerLocations(WorldPool& worlds)
 // Load the world based on the given world graph file, macros file, loation data file, item data file, and area data file
 int World::loadWorld(const fspath& worldFilePath, const fspath& macrosFilePath, const fspath& locationDataPath, const fspath& itemDataPath, const fspath& areaDataPath)
 {
-    LOG_TO_DEBUG("Loading world");
-    // load and parse items
-    YAML::Node itemDataTree;
-    if(!LoadYAML(itemDataTree, itemDataPath, true)) {
-        ErrorLog::getInstance().log("Could not load " + Utility::toUtf8String(itemDataPath));
+    const auto worldTemplate = WorldTemplate::get(worldFilePath, macrosFilePath, locationDataPath, itemDataPath, areaDataPath);
+    if (worldTemplate == nullptr)
+    {
         return 1;
     }
-    for (const auto& item : itemDataTree)
+
+    return loadWorld(*worldTemplate);
+}
+
+// Load the world from the already parsed data files
+int World::loadWorld(const WorldTemplate& worldTemplate)
+{
+    LOG_TO_DEBUG("Loading world");
+    // load and parse items
+    for (const auto& item : worldTemplate.itemData)
     {
         if (const WorldLoadingError err = loadItem(item); err != WorldLoadingError::NONE)
         {
@@ -1201,41 +1212,33 @@ int World::loadWorld(const fspath& worldFilePath, const fspath& macrosFilePath,
         }
     }
 
-    // load world graph
-    YAML::Node worldDataTree;
-    if(!LoadYAML(worldDataTree, worldFilePath, true)) {
-        ErrorLog::getInstance().log("Could not load " + Utility::toUtf8String(worldFilePath));
-        return 1;
-    }
-    // First pass to get area names
-    for (const auto& area : worldDataTree)
+    // First pass of world graph to get area names
+    for (const auto& area : worldTemplate.worldData)
     {
         auto areaName = area["Name"].as<std::string>();
         // Construct Area object (struct) with just the name for now
         areaTable[areaName] = std::make_unique<Area>();
         areaTable[areaName]->name = areaName;
     }
-
-    // Read and parse macros
-    YAML::Node macroListTree;
-    if(!LoadYAML(macroListTree, macrosFilePath, true)) {
-        ErrorLog::getInstance().log("Could not load " + Utility::toUtf8String(macrosFilePath));
-        return 1;
+    areasByIndex.clear();
+    for (auto& [name, area] : areaTable)
+    {
+        area->index = areasByIndex.size();
+        areasByIndex.push_back(area.get());
     }
-    if (const WorldLoadingError err = loadMacros(macroListTree); err != WorldLoadingError::NONE)
+    root = getArea("Root");
+    entrancesByIndex.clear();
+
+    // Parse macros
+    if (const WorldLoadingError err = loadMacros(worldTemplate.macros); err != WorldLoadingError::NONE)
     {
         ErrorLog::getInstance().log("Got error loading macros for world " + std::to_string(worldId + 1) + ": " + errorToName(err));
         ErrorLog::getInstance().log(getLastErrorDetails());
         return 1;
     }
 
-    // Read and parse location data
-    YAML::Node locationDataTree;
-    if(!LoadYAML(locationDataTree, locationDataPath, true)) {
-        ErrorLog::getInstance().log("Could not load " + Utility::toUtf8String(locationDataPath));
-        return 1;
-    }
-    for (const auto& locationObject : locationDataTree)
+    // Parse location data
+    for (const auto& locationObject : worldTemplate.locationData)
     {
         if (const WorldLoadingError err = loadLocation(locationObject); err != WorldLoadingError::NONE)
         {
@@ -1244,9 +1247,15 @@ int World::loadWorld(const fspath& worldFilePath, const fspath& macrosFilePath,
             return 1;
         }
     }
+    locationsByIndex.clear();
+    for (auto& [name, location] : locationTable)
+    {
+        location->index = locationsByIndex.size();
+        locationsByIndex.push_back(location.get());
+    }
 
     // Second pass of world graph to load each area's data
-    for (const auto& area : worldDataTree)
+    for (const auto& area : worldTemplate.worldData)
     {
         if (const WorldLoadingError err = loadArea(area); err != WorldLoadingError::NONE)
         {
@@ -1256,13 +1265,8 @@ int World::loadWorld(const fspath& worldFilePath, const fspath& macrosFilePath,
         }
     }
 
-    // Read and parse area translations for hints/spoiler logs in other languages
-    YAML::Node areaDataTree;
-    if(!LoadYAML(areaDataTree, areaDataPath, true)) {
-        ErrorLog::getInstance().log("Could not load " + Utility::toUtf8String(areaDataPath));
-        return 1;
-    }
-    for (const auto& areaObject : areaDataTree)
+    // Parse area translations for hints/spoiler logs in other languages
+    for (const auto& areaObject : worldTemplate.areaData)
     {
         if (const WorldLoadingError err = loadAreaTranslations(areaObject); err != WorldLoadingError::NONE)
         {
@@ -1278,6 +1282,8 @@ int World::loadWorld(const fspath& worldFilePath, const fspath& macrosFilePath,
     {
         for (auto& exit : area->exits)
         {
+            exit.setIndex(entrancesByIndex.size());
+            entrancesByIndex.push_back(&exit);
             exit.connect(exit.getConnectedArea());
             exit.setOriginalName();
 
@@ -1296,13 +1302,14 @@ int World::loadWorld(const fspath& worldFilePath, const fspath& macrosFilePath,
     }
 
     // Load dungeon wind warp exit info
-    if (const WorldLoadingError err = loadDungeonExitInfo(); err != WorldLoadingError::NONE)
+    if (const WorldLoadingError err = loadDungeonExitInfo(worldTemplate.dungeonEntranceInfo); err != WorldLoadingError::NONE)
     {
         ErrorLog::getInstance().log("Got error loading dungeon exit info: " + errorToName(err));
         ErrorLog::getInstance().log(getLastErrorDetails());
         return 1;
     }
 
+    compileLogicRequirements();
     return 0;
 }
 
@@ -1342,7 +1349,8 @@ Entrance* World::getEntrance(Area* parentArea, Area* connectedArea)
 
 void World::removeEntrance(Entrance* entranceToRemove)
 {
-    std::list<Entrance>& areaExits = getArea(entranceToRemove->getParentArea()->name)->exits;
+    entrancesByIndex[entranceToRemove->getIndex()] = nullptr;
+    std::list<Entrance>& areaExits = entranceToRemove->getParentArea()->exits;
     std::erase_if(areaExits, [entranceToRemove](const Entrance& entrance)
     {
         return &entrance == entranceToRemove;
@@ -1441,6 +1449,7 @@ void World::flattenLogicRequirements()
     // each location
     auto flatten = FlattenSearch(this);
     flatten.doSearch();
+    compileLogicRequirements();
 
     // For each location, note down any item
     // that appears in it's simplified requirement
@@ -1506,6 +1515,37 @@ void World::flattenLogicRequirements()
     }
 }
 
+// Lower every requirement in the world graph into a RequirementProgram for
+// the searching algorithm. Since macros are inlined into each program, this
+// is redone right away whenever a macro or requirement changes. Searches only
+// read the programs, so they never compile anything themselves and can run
+// on several threads at once.
+void World::compileLogicRequirements()
+{
+    for (auto& [name, area] : areaTable)
+    {
+        for (auto& eventAccess : area->events)
+        {
+            eventAccess.program.compile(eventAccess.requirement, this);
+        }
+        for (auto& locAccess : area->locations)
+        {
+            locAccess.program.compile(locAccess.requirement, this);
+        }
+        for (auto& exit : area->exits)
+        {
+            exit.compileRequirement();
+        }
+    }
+
+    for (auto& [name, location] : locationTable)
+    {
+        location->computedRequirementProgram.compile(location->computedRequirement, this);
+    }
+
+    logicRequirementsCompiled = true;
+}
+
 bool World::isSphereEvent(const EventId& event)
 {
     static const std::unordered_set<std::string> sphereEvents = {
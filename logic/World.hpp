@@ -22,6 +22,8 @@
 #define GET_COMPLETE_PROGRESSION_LOCATION_POOL(locationPool, worlds) for (auto& world : worlds) {addElementsToPool(locationPool, world.getProgressionLocations());}
 #define ANY_WORLD_HAS_RACE_MODE(worlds) std::ranges::any_of(worlds, [](const World& world){return world.getSettings().progression_dungeons == ProgressionDungeons::RaceMode;})
 
+class WorldTemplate;
+
 using LocationPool = std::vector<Location*>;
 using EntrancePool = std::vector<Entrance*>;
 
@@ -84,6 +86,7 @@ public:
     WorldLoadingError setDungeonLocations();
     WorldLoadingError determineRequiredDungeons(WorldPool& worlds);
     int loadWorld(const fspath& worldFilePath, const fspath& macrosFilePath, const fspath& locationDataPath, const fspath& itemDataPath, const fspath& areaDataPath);
+    int loadWorld(const WorldTemplate& worldTemplate);
     Entrance* getEntrance(const std::string& parentArea, const std::string& connectedArea);
     Entrance* getEntrance(Area* parentArea, Area* connectedArea);
     void removeEntrance(Entrance* entranceToRemove);
@@ -97,6 +100,8 @@ public:
     void addLocation(const std::string& locationName);
     Item getItem(const std::string& itemName);
     void flattenLogicRequirements();
+    void compileLogicRequirements();
+    bool logicRequirementsAreCompiled() const { return logicRequirementsCompiled; }
     bool isSphereEvent(const EventId& event);
 
     // Stuff to help with debugging
@@ -110,6 +115,13 @@ public:
     std::map<std::string, Item> itemTable = {};
     std::map<std::string, std::unique_ptr<Area>> areaTable = {};
     std::map<std::string, std::unique_ptr<Location>> locationTable = {};
+    // The same areas, locations and entrances by their index, so searches don't
+    // have to go through names. The tables above are only for lookups by name.
+    // Removed entrances are left as nullptr since their indices aren't reused
+    std::vector<Area*> areasByIndex = {};
+    std::vector<Location*> locationsByIndex = {};
+    std::vector<Entrance*> entrancesByIndex = {};
+    Area* root = nullptr;
     std::map<GameItem, std::map<std::string, Text::Translation>> itemTranslations; // game item names for all languages, keyed by GameItemId, language, and type
     std::map<std::string, std::map<std::string, Text::Translation>> hintRegions; // hint region names for all languages, keyed by name, language, and type
     std::unordered_map<std::string, EventId> eventMap = {};
@@ -117,7 +129,7 @@ public:
     std::map<std::string, Dungeon> dungeons = {};
     LocationPool bossLocations = {};
     std::list<Location*> goalLocations = {};
-    std::map<std::string, std::unordered_set<Location*>> barrenRegions = {};
+    std::map<std::string, LocationSet> barrenRegions = {};
     std::list<Hint> korlHints = {};
     std::list<Hint> korlHyruleHints = {};
     std::list<Hint> kreebHints = {};
@@ -125,7 +137,7 @@ public:
     Hint bigOctoFairyHint{};
     std::list<std::list<Location*>> playthroughSpheres = {};
     std::list<std::list<Entrance*>> entranceSpheres = {};
-    std::list<std::list<EventId>> eventSpheres = {};
+    std::list<std::list<EventAccess*>> eventSpheres = {};
     std::map<uint8_t, GameItem> chartMappings = {};
     Settings originalSettings;
 
@@ -134,6 +146,9 @@ public:
 
 
 private:
+    friend void copyWorlds(const WorldPool& worlds, WorldPool& copies);
+
+    void setChartMacro(GameItem chart, uint8_t islandNum);
 
     bool chartLeadsToSunkenTreasure(Location* location, const std::string& itemPrefix);
     RequirementError parseMacro(const std::string& macroLogicExpression, Requirement& reqOut);
@@ -146,14 +161,13 @@ private:
     WorldLoadingError loadArea(const YAML::Node& areaObject);
     WorldLoadingError loadItem(const YAML::Node& itemObject);
     WorldLoadingError loadAreaTranslations(const YAML::Node& areaObject);
-    WorldLoadingError loadDungeonExitInfo();
+    WorldLoadingError loadDungeonExitInfo(const YAML::Node& dungeonExitTree);
 
     Settings settings;
+    bool logicRequirementsCompiled = false;
     ItemPool itemPool;
     ItemPool startingItems;
     int worldId = -1;
     size_t numWorlds = 1;
-
-public:
-    static int eventCounter;
+    EventId eventCounter = 0;
 };
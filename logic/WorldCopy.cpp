@@ -0,0 +1,261 @@
+
+#include "WorldCopy.hpp"
+
+#include <unordered_map>
+
+// Where everything in the original worlds ended up in the copies
+struct CopiedPointers
+{
+    std::unordered_map<const World*, World*> worlds = {};
+    std::unordered_map<const Area*, Area*> areas = {};
+    std::unordered_map<const Entrance*, Entrance*> entrances = {};
+    std::unordered_map<const Location*, Location*> locations = {};
+    std::unordered_map<const LocationAccess*, LocationAccess*> locationAccesses = {};
+
+    template<typename T>
+    static T* find(const std::unordered_map<const T*, T*>& copies, const T* original)
+    {
+        if (original == nullptr)
+        {
+            return nullptr;
+        }
+        const auto copy = copies.find(original);
+        return copy != copies.end() ? copy->second : nullptr;
+    }
+
+    World* operator()(const World* world) const { return find(worlds, world); }
+    Area* operator()(const Area* area) const { return find(areas, area); }
+    Entrance* operator()(const Entrance* entrance) const { return find(entrances, entrance); }
+    Location* operator()(const Location* location) const { return find(locations, location); }
+    LocationAccess* operator()(const LocationAccess* locationAccess) const { return find(locationAccesses, locationAccess); }
+
+    template<typename Container>
+    void inPlace(Container& pointers) const
+    {
+        for (auto& pointer : pointers)
+        {
+            pointer = (*this)(pointer);
+        }
+    }
+
+    void inPlace(Item& item) const
+    {
+        if (item.getWorld() != nullptr)
+        {
+            item.setWorld((*this)(item.getWorld()));
+        }
+        const auto& chainLocations = item.getChainLocations();
+        if (!chainLocations.empty())
+        {
+            std::unordered_set<Location*> copiedChainLocations = {};
+            for (const auto location : chainLocations)
+            {
+                copiedChainLocations.insert((*this)(location));
+            }
+            item.setChainLocations(copiedChainLocations);
+        }
+    }
+
+    void inPlace(ItemPool& items) const
+    {
+        for (auto& item : items)
+        {
+            inPlace(item);
+        }
+    }
+
+    void inPlace(Requirement& req) const
+    {
+        for (auto& arg : req.args)
+        {
+            if (std::holds_alternative<Item>(arg))
+            {
+                inPlace(std::get<Item>(arg));
+            }
+            else if (std::holds_alternative<Requirement>(arg))
+            {
+                inPlace(std::get<Requirement>(arg));
+            }
+        }
+    }
+};
+
+static void copyLocation(const Location& original, Location& copy)
+{
+    copy.names = original.names;
+    copy.categories = original.categories;
+    copy.progression = original.progression;
+    copy.isBossLocation = original.isBossLocation;
+    copy.isRequiredBossLocation = original.isRequiredBossLocation;
+    copy.stageId = original.stageId;
+    copy.plandomized = original.plandomized;
+    copy.hasBeenHinted = original.hasBeenHinted;
+    copy.hasKnownVanillaItem = original.hasKnownVanillaItem;
+    copy.hasExpectedItem = original.hasExpectedItem;
+    copy.hasDungeonDependency = original.hasDungeonDependency;
+    copy.originalItem = original.originalItem;
+    copy.currentItem = original.currentItem;
+    copy.sortPriority = original.sortPriority;
+    copy.index = original.index;
+    copy.hintRegions = original.hintRegions;
+    copy.accessPoints = original.accessPoints;
+    copy.hintPriority = original.hintPriority;
+    copy.method = original.method != nullptr ? original.method->duplicate() : nullptr;
+    copy.world = original.world;
+    copy.computedRequirement = original.computedRequirement;
+    copy.itemsInComputedRequirement = original.itemsInComputedRequirement;
+    copy.pathLocations = original.pathLocations;
+    copy.onPathToGanondorf = original.onPathToGanondorf;
+    copy.itemCanBeBarren = original.itemCanBeBarren;
+    copy.outsideDependentLocations = original.outsideDependentLocations;
+    copy.hasBeenFound = original.hasBeenFound;
+    copy.messageLabel = original.messageLabel;
+    copy.goalNames = original.goalNames;
+    copy.marked = original.marked;
+    copy.trackerNote = original.trackerNote;
+    copy.trackerNoteAreas = original.trackerNoteAreas;
+}
+
+void copyWorlds(const WorldPool& worlds, WorldPool& copies)
+{
+    // Worlds are pointed at, so make them all before copying anything into them
+    copies.clear();
+    copies.reserve(worlds.size());
+    CopiedPointers copied;
+    for (const auto& world : worlds)
+    {
+        copied.worlds[&world] = &copies.emplace_back();
+    }
+
+    // Copy everything as is first, then point the copies at each other once
+    // everything they could point at has been made
+    for (size_t i = 0; i < worlds.size(); i++)
+    {
+        const World& original = worlds[i];
+        World& copy = copies[i];
+
+        copy.settings = original.settings;
+        copy.originalSettings = original.originalSettings;
+        copy.worldId = original.worldId;
+        copy.numWorlds = original.numWorlds;
+        copy.eventCounter = original.eventCounter;
+        copy.itemPool = original.itemPool;
+        copy.startingItems = original.startingItems;
+        copy.macroNameMap = original.macroNameMap;
+        copy.macros = original.macros;
+        copy.macroStrings = original.macroStrings;
+        copy.itemTable = original.itemTable;
+        copy.areasByIndex = original.areasByIndex;
+        copy.locationsByIndex = original.locationsByIndex;
+        copy.entrancesByIndex = original.entrancesByIndex;
+        copy.root = original.root;
+        copy.itemTranslations = original.itemTranslations;
+        copy.hintRegions = original.hintRegions;
+        copy.eventMap = original.eventMap;
+        copy.reverseEventMap = original.reverseEventMap;
+        copy.dungeons = original.dungeons;
+        copy.bossLocations = original.bossLocations;
+        copy.goalLocations = original.goalLocations;
+        copy.chartMappings = original.chartMappings;
+        copy.startingIslandRoomNum = original.startingIslandRoomNum;
+
+        for (const auto& [name, area] : original.areaTable)
+        {
+            const auto& areaCopy = copy.areaTable.emplace(name, std::make_unique<Area>(*area)).first->second;
+            copied.areas[area.get()] = areaCopy.get();
+            for (auto exit = area->exits.begin(), exitCopy = areaCopy->exits.begin(); exit != area->exits.end(); exit++, exitCopy++)
+            {
+                copied.entrances[&*exit] = &*exitCopy;
+            }
+            for (auto locAccess = area->locations.begin(), locAccessCopy = areaCopy->locations.begin(); locAccess != area->locations.end(); locAccess++, locAccessCopy++)
+            {
+                copied.locationAccesses[&*locAccess] = &*locAccessCopy;
+            }
+        }
+
+        for (const auto& [name, location] : original.locationTable)
+        {
+            const auto& locationCopy = copy.locationTable.emplace(name, std::make_unique<Location>()).first->second;
+            copyLocation(*location, *locationCopy);
+            copied.locations[location.get()] = locationCopy.get();
+        }
+    }
+
+    for (auto& copy : copies)
+    {
+        copied.inPlace(copy.itemPool);
+        copied.inPlace(copy.startingItems);
+        for (auto& macro : copy.macros)
+        {
+            copied.inPlace(macro);
+        }
+        for (auto& [name, item] : copy.itemTable)
+        {
+            copied.inPlace(item);
+        }
+
+        for (auto& [name, area] : copy.areaTable)
+        {
+            area->world = &copy;
+            copied.inPlace(area->entrances);
+            for (auto& eventAccess : area->events)
+            {
+                eventAccess.area = area.get();
+                eventAccess.world = &copy;
+                copied.inPlace(eventAccess.requirement);
+            }
+            for (auto& locAccess : area->locations)
+            {
+                locAccess.area = area.get();
+                locAccess.location = copied(locAccess.location);
+                copied.inPlace(locAccess.requirement);
+            }
+            for (auto& exit : area->exits)
+            {
+                exit.setParentArea(area.get());
+                exit.setConnectedArea(copied(exit.getConnectedArea()));
+                exit.setOriginalConnectedArea(copied(exit.getOriginalConnectedArea()));
+                exit.setReverse(copied(exit.getReverse()));
+                exit.setReplaces(copied(exit.getReplaces()));
+                exit.setAssumed(copied(exit.getAssumed()));
+                exit.setWorld(&copy);
+                copied.inPlace(exit.getRequirement());
+                auto computedRequirement = exit.getComputedRequirement();
+                copied.inPlace(computedRequirement);
+                exit.setComputedRequirement(computedRequirement);
+            }
+        }
+
+        for (auto& [name, location] : copy.locationTable)
+        {
+            copied.inPlace(location->originalItem);
+            copied.inPlace(location->currentItem);
+            copied.inPlace(location->accessPoints);
+            location->world = &copy;
+            copied.inPlace(location->computedRequirement);
+            copied.inPlace(location->pathLocations);
+            copied.inPlace(location->outsideDependentLocations);
+        }
+
+        for (auto& [name, dungeon] : copy.dungeons)
+        {
+            copied.inPlace(dungeon.smallKey);
+            copied.inPlace(dungeon.bigKey);
+            copied.inPlace(dungeon.map);
+            copied.inPlace(dungeon.compass);
+            copied.inPlace(dungeon.locations);
+            dungeon.bossLocation = copied(dungeon.bossLocation);
+            dungeon.startingArea = copied(dungeon.startingArea);
+            dungeon.startingEntrance = copied(dungeon.startingEntrance);
+        }
+        copied.inPlace(copy.bossLocations);
+        copied.inPlace(copy.goalLocations);
+        copied.inPlace(copy.areasByIndex);
+        copied.inPlace(copy.locationsByIndex);
+        copied.inPlace(copy.entrancesByIndex);
+        copy.root = copied(copy.root);
+
+        // Compile the copies' requirements against their own areas
+        copy.compileLogicRequirements();
+    }
+}
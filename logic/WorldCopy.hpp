@@ -0,0 +1,12 @@
+
+#pragma once
+
+#include <logic/World.hpp>
+
+// Make copies of the worlds which share nothing with them, so changes can be
+// tried out on the copies from another thread. Everything the logic uses is
+// copied (settings, areas, entrances, locations, items and dungeons) and points
+// at the other copies instead of the originals. Hints, playthroughs, barren
+// regions and plandomizer data are left out since they aren't part of the logic.
+// Anything already in copies is replaced
+void copyWorlds(const WorldPool& worlds, WorldPool& copies);
@@ -0,0 +1,136 @@
+
+#include "WorldSnapshot.hpp"
+
+// Entrances are numbered world by world. Entrances only ever connect to
+// and replace entrances within their own world
+WorldSnapshot::WorldSnapshot(WorldPool& worlds)
+{
+    int numEntrances = 0;
+    int numAreas = 0;
+    for (auto& world : worlds)
+    {
+        entranceOffsets.push_back(numEntrances);
+        areaOffsets.push_back(numAreas);
+        numEntrances += world.entrancesByIndex.size();
+        numAreas += world.areasByIndex.size();
+    }
+    // Removed entrances keep the default state
+    entrances.resize(numEntrances);
+    areaEntrances.resize(numAreas);
+    areasAccessible.resize(numAreas);
+
+    for (auto& world : worlds)
+    {
+        for (const auto entrance : world.entrancesByIndex)
+        {
+            if (entrance != nullptr)
+            {
+                recordConnection(entrance);
+            }
+        }
+
+        for (const auto area : world.areasByIndex)
+        {
+            const int areaId = areaOffsets[world.getWorldId()] + area->index;
+            for (const auto entrance : area->entrances)
+            {
+                areaEntrances[areaId].push_back(entrance->getIndex());
+            }
+            areasAccessible[areaId] = area->isAccessible;
+        }
+
+        for (const auto location : world.locationsByIndex)
+        {
+            if (location->currentItem.getGameItemId() != GameItem::INVALID)
+            {
+                locationItems.emplace_back(locationsFound.size(), location->currentItem);
+            }
+            locationsFound.push_back(location->hasBeenFound);
+        }
+    }
+}
+
+void WorldSnapshot::recordConnection(Entrance* entrance)
+{
+    EntranceState& state = entrances[entranceOffsets[entrance->getWorld()->getWorldId()] + entrance->getIndex()];
+    state.connectedArea = entrance->getConnectedArea() != nullptr ? entrance->getConnectedArea()->index : -1;
+    state.replaces = entrance->getReplaces() != nullptr ? entrance->getReplaces()->getIndex() : -1;
+    state.found = entrance->hasBeenFound();
+}
+
+void WorldSnapshot::recordConnections(const EntrancePool& changedEntrances)
+{
+    // Any area which lost an entrance gained one of the others, so the
+    // areas they're connected to now are the only ones which changed
+    for (const auto entrance : changedEntrances)
+    {
+        recordConnection(entrance);
+        if (const Area* area = entrance->getConnectedArea(); area != nullptr)
+        {
+            const int worldId = entrance->getWorld()->getWorldId();
+            auto& areaEntranceIds = areaEntrances[areaOffsets[worldId] + area->index];
+            areaEntranceIds.clear();
+            for (const auto areaEntrance : area->entrances)
+            {
+                areaEntranceIds.push_back(areaEntrance->getIndex());
+            }
+        }
+    }
+}
+
+void WorldSnapshot::restore(WorldPool& worlds) const
+{
+    size_t locationId = 0;
+    auto nextItem = locationItems.begin();
+    for (auto& world : worlds)
+    {
+        const int entranceOffset = entranceOffsets[world.getWorldId()];
+        for (const auto entrance : world.entrancesByIndex)
+        {
+            if (entrance == nullptr)
+            {
+                continue;
+            }
+            const EntranceState& state = entrances[entranceOffset + entrance->getIndex()];
+            entrance->setConnectedArea(state.connectedArea != -1 ? world.areasByIndex[state.connectedArea] : nullptr);
+            entrance->setReplaces(state.replaces != -1 ? world.entrancesByIndex[state.replaces] : nullptr);
+            entrance->setFound(state.found);
+        }
+
+        for (const auto area : world.areasByIndex)
+        {
+            const int areaId = areaOffsets[world.getWorldId()] + area->index;
+            // Keep the list's nodes when the area has the same number of entrances
+            auto entranceItr = area->entrances.begin();
+            for (const auto& entranceIndex : areaEntrances[areaId])
+            {
+                if (entranceItr == area->entrances.end())
+                {
+                    area->entrances.push_back(world.entrancesByIndex[entranceIndex]);
+                    entranceItr = area->entrances.end();
+                }
+                else
+                {
+                    *entranceItr++ = world.entrancesByIndex[entranceIndex];
+                }
+            }
+            area->entrances.erase(entranceItr, area->entrances.end());
+            area->isAccessible = areasAccessible[areaId];
+        }
+
+        for (const auto location : world.locationsByIndex)
+        {
+            if (nextItem != locationItems.end() && nextItem->first == locationId)
+            {
+                location->currentItem = nextItem->second;
+                nextItem++;
+            }
+            else if (location->currentItem.getGameItemId() != GameItem::INVALID)
+            {
+                location->currentItem = Item(GameItem::INVALID, nullptr);
+            }
+            location->hasBeenFound = locationsFound[locationId];
+            locationId++;
+        }
+    }
+}
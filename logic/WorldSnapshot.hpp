@@ -0,0 +1,44 @@
+
+#pragma once
+
+#include <vector>
+
+#include <logic/World.hpp>
+
+// A copy of the parts of the worlds which change while entrances are shuffled
+// and items are placed: which area each entrance is connected to and which
+// entrance it replaces, the item at each location, and the search variables.
+// Everything is kept in flat arrays indexed by entrance, area and location
+// index, so taking and restoring a snapshot doesn't need any lookups. Worlds
+// built the same way have the same indices, so a snapshot can be put back on
+// the worlds it was taken from or on copies of them, as long as they have the
+// same entrances.
+class WorldSnapshot
+{
+public:
+    WorldSnapshot() = default;
+    explicit WorldSnapshot(WorldPool& worlds);
+
+    // Take in changes to the connections of the given entrances without taking a
+    // whole new snapshot. The areas the entrances now lead into are updated too
+    void recordConnections(const EntrancePool& changedEntrances);
+    void restore(WorldPool& worlds) const;
+
+private:
+    struct EntranceState
+    {
+        int connectedArea = -1; // Area index within the entrance's world
+        int replaces = -1;      // Entrance index within the entrance's world
+        bool found = false;
+    };
+
+    void recordConnection(Entrance* entrance);
+
+    std::vector<int> entranceOffsets = {}; // Where each world's entrances start in entrances
+    std::vector<int> areaOffsets = {};     // Where each world's areas start in areaEntrances and areasAccessible
+    std::vector<EntranceState> entrances = {};
+    std::vector<std::vector<int>> areaEntrances = {}; // Indices of the entrances leading into each area
+    std::vector<char> areasAccessible = {};
+    std::vector<std::pair<size_t, Item>> locationItems = {}; // Only locations which have an item, by location id
+    std::vector<char> locationsFound = {};
+};
@@ -0,0 +1,102 @@
+
+#include "WorldTemplate.hpp"
+
+#include <mutex>
+#include <vector>
+
+#include <logic/LogicCache.hpp>
+#include <command/Log.hpp>
+#include <utility/file.hpp>
+
+bool WorldTemplate::load()
+{
+    const std::pair<YAML::Node&, fspath> files[] = {
+        {worldData, worldFilePath},
+        {macros, macrosFilePath},
+        {locationData, locationDataPath},
+        {itemData, itemDataPath},
+        {areaData, areaDataPath},
+        {dungeonEntranceInfo, Utility::get_data_path() / "logic/dungeon_entrance_info.yaml"},
+    };
+
+    // The source files are always read to check if the cache is still valid
+    std::vector<std::string> contents = {};
+    for (const auto& [tree, path] : files)
+    {
+        if (Utility::getFileContents(path, contents.emplace_back(), true) != 0)
+        {
+            ErrorLog::getInstance().log("Could not load " + Utility::toUtf8String(path));
+            return false;
+        }
+    }
+    sourceHash = logicCacheHash(contents);
+
+    for (const auto& cachePath : {getPrebuiltLogicCachePath(), getLogicCachePath()})
+    {
+        if (const LogicCacheError err = loadLogicCache(cachePath, *this); err == LogicCacheError::NONE)
+        {
+            LOG_TO_DEBUG("Loaded logic cache " + Utility::toUtf8String(cachePath));
+            return true;
+        }
+        else
+        {
+            LOG_TO_DEBUG("Could not use logic cache " + Utility::toUtf8String(cachePath) + ": " + errorGetName(err));
+        }
+    }
+
+    for (size_t i = 0; i < contents.size(); i++)
+    {
+        try
+        {
+            files[i].first = YAML::Load(contents[i]);
+        }
+        catch (const YAML::Exception& ex)
+        {
+            ErrorLog::getInstance().log("Error parsing yaml " + Utility::toUtf8String(files[i].second) + ": " + ex.what());
+            return false;
+        }
+    }
+
+    // Save the parsed files for next time. Not being able to is fine, the files
+    // will just be parsed again
+    if (const LogicCacheError err = writeLogicCache(getLogicCachePath(), *this); err != LogicCacheError::NONE)
+    {
+        LOG_TO_DEBUG("Could not write logic cache: " + errorGetName(err));
+    }
+
+    return true;
+}
+
+std::shared_ptr<const WorldTemplate> WorldTemplate::get(const fspath& worldFilePath, const fspath& macrosFilePath, const fspath& locationDataPath, const fspath& itemDataPath, const fspath& areaDataPath)
+{
+    static std::mutex loadMut;
+    static std::shared_ptr<const WorldTemplate> loaded = nullptr;
+
+    std::scoped_lock lock(loadMut);
+    if (loaded != nullptr && loaded->worldFilePath == worldFilePath && loaded->macrosFilePath == macrosFilePath &&
+        loaded->locationDataPath == locationDataPath && loaded->itemDataPath == itemDataPath && loaded->areaDataPath == areaDataPath)
+    {
+        return loaded;
+    }
+
+    auto worldTemplate = std::make_shared<WorldTemplate>();
+    worldTemplate->worldFilePath = worldFilePath;
+    worldTemplate->macrosFilePath = macrosFilePath;
+    worldTemplate->locationDataPath = locationDataPath;
+    worldTemplate->itemDataPath = itemDataPath;
+    worldTemplate->areaDataPath = areaDataPath;
+    // Don't keep a template which failed to load so the next call tries again
+    if (!worldTemplate->load())
+    {
+        return nullptr;
+    }
+
+    loaded = worldTemplate;
+    return loaded;
+}
+
+std::shared_ptr<const WorldTemplate> WorldTemplate::getDefault()
+{
+    const fspath logicPath = Utility::get_data_path() / "logic";
+    return get(logicPath / "world.yaml", logicPath / "macros.yaml", logicPath / "location_data.yaml", logicPath / "item_data.yaml", logicPath / "area_names.yaml");
+}
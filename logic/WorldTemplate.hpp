@@ -0,0 +1,43 @@
+#pragma once
+
+#include <memory>
+#include <string>
+
+#include <libs/yaml.hpp>
+#include <utility/path.hpp>
+
+// The parsed logic data files every world is built from. None of this depends on
+// settings, so the files are only read and parsed once per process and the same
+// template is shared by every world, build retry and thread afterwards. Worlds
+// copy what they need out of it while loading and never modify it.
+//
+// If a binary logic cache matching the source files exists it is loaded instead
+// of parsing the YAML (see LogicCache.hpp).
+class WorldTemplate
+{
+public:
+    fspath worldFilePath;
+    fspath macrosFilePath;
+    fspath locationDataPath;
+    fspath itemDataPath;
+    fspath areaDataPath;
+
+    YAML::Node worldData;
+    YAML::Node macros;
+    YAML::Node locationData;
+    YAML::Node itemData;
+    YAML::Node areaData;
+    YAML::Node dungeonEntranceInfo;
+
+    // Hash of the source files and program version, used to key the binary logic cache
+    std::string sourceHash;
+
+    // Returns the template for the given files, loading it on first use.
+    // Returns nullptr if any of the files couldn't be loaded
+    static std::shared_ptr<const WorldTemplate> get(const fspath& worldFilePath, const fspath& macrosFilePath, const fspath& locationDataPath, const fspath& itemDataPath, const fspath& areaDataPath);
+    // Returns the template for the default logic files in the data folder
+    static std::shared_ptr<const WorldTemplate> getDefault();
+
+private:
+    bool load();
+};
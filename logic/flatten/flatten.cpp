@@ -122,7 +122,7 @@ bool FlattenSearch::wasUpdated(Area* area, void* thing)
     auto& remoteAreaReqs = remoteAreaRequirements[thing];
     for (auto& area : remoteAreaReqs)
     {
-        if (recentlyUpdatedAreas.contains(world->getArea(area)))
+        if (recentlyUpdatedAreas.contains(world->areasByIndex[area]))
         {
             return true;
         }
@@ -258,7 +258,7 @@ DNF evaluatePartialRequirement(BitIndex& bitIndex, const Requirement& req, Flatt
         return DNF({bits});
 
     case RequirementType::CAN_ACCESS:
-        area = search->world->getArea(std::get<std::string>(req.args[0]));
+        area = search->world->areasByIndex[std::get<AreaIndex>(req.args[0])];
         return search->areaExprs[area];
 
     case RequirementType::NONE:
@@ -38,7 +38,7 @@ public:
     std::set<EventId> newlyUpdatedEvents = {};
 
     std::unordered_map<void*, std::set<EventId>> remoteEventRequirements = {};
-    std::unordered_map<void*, std::set<std::string>> remoteAreaRequirements = {};
+    std::unordered_map<void*, std::set<AreaIndex>> remoteAreaRequirements = {};
     bool newThingsFound = false;
 
     void doSearch();
@@ -66,7 +66,7 @@ std::function<void(const Requirement& req)> visitor(T* thing, FlattenSearch* sea
             {
                 search->remoteAreaRequirements[thingPtr] = {};
             }
-            search->remoteAreaRequirements[thingPtr].insert(std::get<std::string>(req.args[0]));
+            search->remoteAreaRequirements[thingPtr].insert(std::get<AreaIndex>(req.args[0]));
         }
     };
 
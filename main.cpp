@@ -26,10 +26,145 @@
     }
 #else
     #include <thread>
+    #include <string>
+    #include <vector>
+    #include <fstream>
+    #include <chrono>
+    #include <charconv>
+    #include <string_view>
 
     #include <utility/platform.hpp>
     #include <command/Log.hpp>
     #include <randomizer.hpp>
+    #include <logic/BatchGenerate.hpp>
+    #include <logic/WorldTemplate.hpp>
+    #include <logic/LogicCache.hpp>
+    #include <filetypes/yaz0.hpp>
+    #include <utility/file.hpp>
+
+    // Generates the worlds for every permalink in a file (one per line) without
+    // modifying the game, and prints how each one went
+    static int runBatch(const std::string& permalinkFile, const size_t& numThreads) {
+        std::ifstream input(permalinkFile);
+        if(!input.is_open()) {
+            Utility::platformLog("Could not open " + permalinkFile);
+            return 1;
+        }
+
+        std::vector<Config> configs = {};
+        std::string line = "";
+        while(std::getline(input, line)) {
+            if(line.empty()) continue;
+
+            Config& config = configs.emplace_back();
+            if(config.loadPermalink(line) != PermalinkError::NONE) {
+                Utility::platformLog("Invalid permalink: " + line);
+                return 1;
+            }
+        }
+
+        Utility::platformLog("Generating " + std::to_string(configs.size()) + " seeds...");
+        const std::vector<BatchResult> results = generateBatch(configs, numThreads);
+
+        int retVal = 0;
+        for(size_t i = 0; i < results.size(); i++) {
+            const BatchResult& result = results[i];
+            if(result.returnCode == 0) {
+                Utility::platformLog(std::to_string(i) + ": " + result.seedHash + " generated in " + std::to_string(result.time.count()) + "ms");
+            }
+            else {
+                Utility::platformLog(std::to_string(i) + ": " + result.permalink + " failed after " + std::to_string(result.time.count()) + "ms\n" + result.errors);
+                retVal = 1;
+            }
+        }
+
+        return retVal;
+    }
+
+    // Parses the logic files and saves them as the prebuilt logic cache in the data folder
+    static int buildLogicCache() {
+        const auto worldTemplate = WorldTemplate::getDefault();
+        if(worldTemplate == nullptr) {
+            Utility::platformLog("Could not load logic files\n" + ErrorLog::getInstance().getLastErrors());
+            return 1;
+        }
+
+        if(const LogicCacheError err = writeLogicCache(getPrebuiltLogicCachePath(), *worldTemplate); err != LogicCacheError::NONE) {
+            Utility::platformLog("Could not write logic cache: " + errorGetName(err));
+            return 1;
+        }
+
+        Utility::platformLog("Wrote " + Utility::toUtf8String(getPrebuiltLogicCachePath()));
+        return 0;
+    }
+
+    // Compares the speed and size of each YAZ0 compression mode on some files
+    // Files that are already compressed (like stage .szs archives) are decompressed first
+    static int benchmarkYaz0(const std::vector<std::string>& files) {
+        struct Mode {
+            std::string name;
+            uint32_t level;
+            uint32_t numThreads;
+            size_t totalSize = 0;
+            std::chrono::milliseconds totalTime{0};
+        };
+        std::vector<Mode> modes = {
+            {"level 9 (reference)", 9, 1},
+            {"level 8", 8, 1},
+            {"level 7", 7, 1},
+            {"level 7 (all cores)", 7, 0},
+            {"level 3", 3, 1},
+        };
+
+        size_t totalInput = 0;
+        for(const std::string& file : files) {
+            std::string data;
+            if(Utility::getFileContents(file, data) != 0) {
+                Utility::platformLog("Could not read " + file);
+                return 1;
+            }
+
+            if(data.starts_with("Yaz0")) {
+                std::string decoded;
+                if(FileTypes::yaz0Decode(data, decoded) != YAZ0Error::NONE) {
+                    Utility::platformLog("Could not decompress " + file);
+                    return 1;
+                }
+                data = std::move(decoded);
+            }
+            totalInput += data.size();
+
+            std::string line = file + " (" + std::to_string(data.size()) + " bytes):";
+            for(Mode& mode : modes) {
+                std::string encoded, decoded;
+                const auto start = std::chrono::steady_clock::now();
+                if(FileTypes::yaz0Encode(data, encoded, mode.level, mode.numThreads) != YAZ0Error::NONE) {
+                    Utility::platformLog("Could not compress " + file + " with " + mode.name);
+                    return 1;
+                }
+                const auto time = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+
+                // Make sure everything still decompresses to the original data
+                if(FileTypes::yaz0Decode(encoded, decoded) != YAZ0Error::NONE || decoded != data) {
+                    Utility::platformLog("Round trip failed for " + file + " with " + mode.name);
+                    return 1;
+                }
+
+                mode.totalSize += encoded.size();
+                mode.totalTime += time;
+                line += "\n    " + mode.name + ": " + std::to_string(encoded.size()) + " bytes in " + std::to_string(time.count()) + "ms";
+            }
+            Utility::platformLog(line);
+        }
+
+        Utility::platformLog("Total (" + std::to_string(totalInput) + " bytes):");
+        for(const Mode& mode : modes) {
+            const double ratio = totalInput == 0 ? 0.0 : 100.0 * mode.totalSize / totalInput;
+            Utility::platformLog("    " + mode.name + ": " + std::to_string(mode.totalSize) + " bytes (" + std::to_string(ratio) + "%) in " + std::to_string(mode.totalTime.count()) + "ms");
+        }
+
+        return 0;
+    }
 #endif
 
 int main(int argc, char *argv[]) {
@@ -79,6 +214,54 @@ int main(int argc, char *argv[]) {
 #else
     using namespace std::literals::chrono_literals;
 
+    if(argc > 1 && std::string(argv[1]) == "--build-logic-cache") {
+        if(!Utility::platformInit()) {
+            Utility::platformLog("Failed to initialize platform!");
+            return 1;
+        }
+
+        const int retVal = buildLogicCache();
+
+        Utility::platformShutdown();
+        return retVal;
+    }
+
+    // --yaz0-benchmark <file> [more files...]
+    if(argc > 2 && std::string(argv[1]) == "--yaz0-benchmark") {
+        if(!Utility::platformInit()) {
+            Utility::platformLog("Failed to initialize platform!");
+            return 1;
+        }
+
+        const int retVal = benchmarkYaz0(std::vector<std::string>(argv + 2, argv + argc));
+
+        Utility::platformShutdown();
+        return retVal;
+    }
+
+    // --batch <permalink file> [threads]
+    if(argc > 2 && std::string(argv[1]) == "--batch") {
+        if(!Utility::platformInit()) {
+            Utility::platformLog("Failed to initialize platform!");
+            return 1;
+        }
+
+        size_t numThreads = 0;
+        if(argc > 3) {
+            const std::string_view threadArg = argv[3];
+            if(const auto [end, err] = std::from_chars(threadArg.data(), threadArg.data() + threadArg.size(), numThreads); err != std::errc() || end != threadArg.data() + threadArg.size()) {
+                Utility::platformLog("Invalid thread count \"" + std::string(threadArg) + "\"");
+                Utility::platformLog("Usage: --batch <permalink file> [threads]");
+                Utility::platformShutdown();
+                return 1;
+            }
+        }
+        const int retVal = runBatch(argv[2], numThreads);
+
+        Utility::platformShutdown();
+        return retVal;
+    }
+
     if(Utility::platformInit()) {
         int retVal = mainRandomize();
 
@@ -7,6 +7,7 @@
 #include <utility/file.hpp>
 #include <utility/math.hpp>
 #include <utility/string.hpp>
+#include <command/Log.hpp>
 
 #include <gui/desktop/update_dialog_header.hpp>
 
@@ -29,13 +30,37 @@ void Content::Update(const std::vector<FSTEntry*>& entries) {
 
 static constexpr std::streamsize MAX_SSTREAM_SIZE = 1024 * 1024 * 500;
 static constexpr size_t READ_BUFFER_SIZE = 1024 * 1024 * 8;
-static char readBuffer[READ_BUFFER_SIZE];
+
+// Copy the whole file onto the end of output. Mapped files are copied straight out of the
+// mapping, but without mmap that would read each file into memory whole, so read it in chunks
+static bool appendFile(const fspath& path, std::ostream& output, std::string& readBuffer) {
+    if constexpr (Utility::MappedFile::mapsFiles) {
+        Utility::MappedFile input;
+        if(input.open(path) != 0) return false;
+
+        const std::string_view inputData = input.view();
+        output.write(inputData.data(), inputData.size());
+    }
+    else {
+        std::ifstream input(path, std::ios::binary);
+        if(!input.is_open()) return false;
+
+        readBuffer.resize(READ_BUFFER_SIZE);
+        while(input) {
+            input.read(readBuffer.data(), readBuffer.size());
+            output.write(readBuffer.data(), input.gcount());
+        }
+    }
+
+    return true;
+}
 
 std::variant<std::stringstream, std::ifstream> Content::PackDecrypted()
 {
     const fspath& tmpPath = Utility::get_temp_dir() / (Utility::Str::intToHex(id, 8, false) + ".dec");
     std::stringstream output;
     std::ofstream outFile;
+    std::string readBuffer; // only allocated if files are read in chunks
 
     size_t count = 0;
     
@@ -46,10 +71,8 @@ std::variant<std::stringstream, std::ifstream> Content::PackDecrypted()
         {
             const FSTEntry::FileEntry& entry = std::get<FSTEntry::FileEntry>(pEntry->entry);
 
-            std::ifstream input(pEntry->path, std::ios::binary);
-            while(input) {
-                input.read(readBuffer, READ_BUFFER_SIZE);
-                output.write(readBuffer, input.gcount());
+            if(!appendFile(pEntry->path, output, readBuffer)) {
+                ErrorLog::getInstance().log("Could not read " + Utility::toUtf8String(pEntry->path) + " into content " + Utility::Str::intToHex(id, 8, false));
             }
 
             uint64_t alignedFileSize = roundUp(entry.fileSize, ALIGNMENT_IN_CONTENT);
@@ -63,7 +86,7 @@ std::variant<std::stringstream, std::ifstream> Content::PackDecrypted()
                     outFile.open(tmpPath, std::ios::binary);
                 }
 
-                const std::string& strm = output.str();
+                const std::string_view strm = output.view();
                 outFile.write(strm.data(), strm.size());
                 output.str(std::string()); // reset stringstream
             }
@@ -81,7 +104,7 @@ std::variant<std::stringstream, std::ifstream> Content::PackDecrypted()
     }
 
     if(outFile.is_open()) {
-        const std::string& remaining = output.str();
+        const std::string_view remaining = output.view();
         outFile.write(remaining.data(), remaining.size()); // write whatever is left at the end
 
         outFile.close();
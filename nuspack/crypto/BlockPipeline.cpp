@@ -0,0 +1,88 @@
+#include "BlockPipeline.hpp"
+
+#include <algorithm>
+#include <future>
+#include <string>
+#include <vector>
+
+#include <libs/BS_thread_pool.hpp>
+
+static constexpr uint32_t BATCH_SIZE = 64; // in blocks, ~4MB of input
+
+// Made on first use so the threads only exist once something is packed
+static BS::thread_pool& getPackThreads() {
+    #ifdef DEVKITPRO
+        static BS::thread_pool packThreads(3);
+    #else
+        static BS::thread_pool packThreads(std::thread::hardware_concurrency() ? std::thread::hardware_concurrency() : 4);
+    #endif
+
+    return packThreads;
+}
+
+namespace {
+    struct Batch {
+        std::string input;
+        std::string output;
+        uint32_t firstBlock = 0;
+        uint32_t numBlocks = 0;
+        std::vector<std::future<void>> jobs = {};
+    };
+}
+
+namespace BlockPipeline {
+    void run(std::istream& input, const uint32_t& numBlocks, const size_t& outputSize, const Work_t& work, const Finish_t& finish) {
+        if(numBlocks == 0) return;
+
+        BS::thread_pool& threads = getPackThreads();
+
+        // One batch is read and written while the other is worked on, small contents don't need the full size
+        const uint32_t batchSize = std::min(BATCH_SIZE, numBlocks);
+        Batch batches[2];
+        for(Batch& batch : batches) {
+            batch.input.resize(batchSize * BLOCK_SIZE);
+            batch.output.resize(batchSize * outputSize);
+        }
+
+        const auto readBatch = [&](Batch& batch, const uint32_t& firstBlock) {
+            batch.firstBlock = firstBlock;
+            batch.numBlocks = std::min(batchSize, numBlocks - firstBlock);
+
+            const size_t readSize = batch.numBlocks * BLOCK_SIZE;
+            input.read(batch.input.data(), readSize);
+            std::fill(batch.input.begin() + input.gcount(), batch.input.begin() + readSize, '\0');
+        };
+
+        const auto startBatch = [&](Batch& batch) {
+            batch.jobs.clear();
+            for(uint32_t i = 0; i < batch.numBlocks; i++) {
+                batch.jobs.push_back(threads.submit([&batch, &work, &outputSize, i]() {
+                    work(batch.input.data() + i * BLOCK_SIZE, batch.firstBlock + i, batch.output.data() + i * outputSize);
+                }));
+            }
+        };
+
+        readBatch(batches[0], 0);
+        startBatch(batches[0]);
+        uint32_t nextBlock = batches[0].numBlocks;
+        for(size_t cur = 0; ; cur ^= 1) {
+            Batch& current = batches[cur];
+            Batch& upcoming = batches[cur ^ 1];
+            const bool hasNext = nextBlock < numBlocks;
+
+            if(hasNext) readBatch(upcoming, nextBlock);
+            for(auto& job : current.jobs) {
+                job.get();
+            }
+
+            // Keep the threads busy while this batch is written out
+            if(hasNext) {
+                startBatch(upcoming);
+                nextBlock += upcoming.numBlocks;
+            }
+            finish(current.output.data(), current.firstBlock, current.numBlocks);
+
+            if(!hasNext) break;
+        }
+    }
+}
@@ -0,0 +1,21 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <iostream>
+
+// Hashed contents are hashed and encrypted in 0xFC00 byte blocks that don't depend on
+// each other once the hash tree is known, so they're split up between threads.
+// Blocks are read a batch at a time into buffers that get reused, and the next batch
+// is read while the threads work on the current one
+namespace BlockPipeline {
+    static constexpr uint32_t BLOCK_SIZE = 0xFC00;
+
+    // Runs on the worker threads, turns one block into a fixed size output. Blocks past
+    // the end of the input are zero padded to the full block size
+    using Work_t = std::function<void(const char* block, const uint32_t& blockIndex, char* output)>;
+    // Runs on the calling thread once every block in a batch is done, batches come in order
+    using Finish_t = std::function<void(const char* output, const uint32_t& firstBlock, const uint32_t& numBlocks)>;
+
+    void run(std::istream& input, const uint32_t& numBlocks, const size_t& outputSize, const Work_t& work, const Finish_t& finish);
+}
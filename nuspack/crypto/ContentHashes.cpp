@@ -3,6 +3,7 @@
 #include <sstream>
 
 #include <nuspack/contents/contents.hpp>
+#include <nuspack/crypto/BlockPipeline.hpp>
 #include <libs/hashing.hpp>
 #include <utility/file.hpp>
 #include <utility/math.hpp>
@@ -48,24 +49,26 @@ void ContentHashes::CalculateOtherHashes(const uint32_t& hashLevel, const Hashes
 }
 
 void ContentHashes::CalculateH0Hashes(std::istream& file) {
-    static constexpr uint32_t bufferSize = 0xFC00;
-
-    blockCount = 0;
-    std::string buffer(bufferSize, '\0');
-    while (file)
-    {
-        file.read(buffer.data(), buffer.size());
-
-        if(file.gcount() > 0) {
-            const std::string hash = sha1(buffer.data(), buffer.size());
-            std::copy(hash.begin(), hash.end(), h0Hashes[blockCount].begin());
-
-            blockCount++;
+    const uint64_t size = file.seekg(0, std::ios::end).tellg();
+    file.seekg(0, std::ios::beg);
+
+    blockCount = static_cast<uint32_t>(roundUp<uint64_t>(size, BlockPipeline::BLOCK_SIZE) / BlockPipeline::BLOCK_SIZE);
+    BlockPipeline::run(file, blockCount, sizeof(SHA1_t),
+        [](const char* block, const uint32_t&, char* hash) {
+            SHA1 blockSha1; // the shared one isn't thread safe
+            const std::string blockHash = blockSha1(block, BlockPipeline::BLOCK_SIZE);
+            std::copy(blockHash.begin(), blockHash.end(), hash);
+        },
+        [this](const char* hashes, const uint32_t& firstBlock, const uint32_t& numHashed) {
+            for (uint32_t i = 0; i < numHashed; i++)
+            {
+                std::copy(hashes + i * sizeof(SHA1_t), hashes + (i + 1) * sizeof(SHA1_t), h0Hashes[firstBlock + i].begin());
+            }
         }
-    }
+    );
 }
 
-std::string ContentHashes::GetHashForBlock(uint32_t block) {
+std::string ContentHashes::GetHashForBlock(uint32_t block) const {
     std::stringstream hashes;
 
     if(block > blockCount) {
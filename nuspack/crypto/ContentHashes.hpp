@@ -21,7 +21,7 @@ public:
     ContentHashes(std::istream& file, const bool& hashed);
     void CalculateOtherHashes(const uint32_t& hashLevel, const Hashes_t& inHashes, Hashes_t& outHashes);
     void CalculateH0Hashes(std::istream& file);
-    std::string GetHashForBlock(uint32_t block);
+    std::string GetHashForBlock(uint32_t block) const;
     std::vector<SHA1_t> GetH3Hashes();
     void SaveH3ToFile(std::ostream& out);
 };
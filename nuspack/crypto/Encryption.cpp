@@ -1,8 +1,11 @@
 #include "Encryption.hpp"
 
+#include <memory>
+
 #include <utility/endian.hpp>
 #include <utility/math.hpp>
 #include <nuspack/contents/contents.hpp>
+#include <nuspack/crypto/BlockPipeline.hpp>
 
 #include <gui/desktop/update_dialog_header.hpp>
 
@@ -22,67 +25,67 @@ void Encryption::EncryptSingleFile(std::istream& input, std::ostream& output, co
     input.seekg(0, std::ios::beg);
     
     uint64_t cur_position = 0;
+    std::string blockBuffer(blockSize, '\0');
+    std::string encrypted(blockSize, '\0');
     do
     {
-        std::string blockBuffer(blockSize, '\0');
         input.read(blockBuffer.data(), blockBuffer.size());
-        blockBuffer = Encrypt(blockBuffer).str();
+        std::fill(blockBuffer.begin() + input.gcount(), blockBuffer.end(), '\0');
+        Encrypt(blockBuffer.data(), blockSize, iv, encrypted.data());
 
-        std::copy(blockBuffer.end() - 16, blockBuffer.end(), iv.begin());
+        std::copy(encrypted.end() - 16, encrypted.end(), iv.begin());
 
         cur_position += blockSize;
-        output.write(blockBuffer.data(), blockBuffer.size());
+        output.write(encrypted.data(), encrypted.size());
     } while (cur_position < targetSize && input/* .gcount() == blockSize */);
 }
 
-void Encryption::EncryptFileHashed(std::istream& input, std::ostream& output, const uint64_t& len, Content& content, ContentHashes& hashes) {
-    constexpr uint32_t hashBlockSize = 0xFC00;
-
-    uint32_t block = 0;
-    std::string buffer(hashBlockSize, '\0');
-    do
-    {
-        input.read(buffer.data(), buffer.size());
-
-        const std::stringstream& encrypted = EncryptChunkHashed(buffer, block, hashes, content);
-        output << encrypted.rdbuf();
-
-        block++;
-        // Update progress dialogue
-        if (block > 1000)
-        {
-            UPDATE_DIALOG_VALUE(149 + (int)(((float) (input.gcount() * block) / (float) len) * 50.0f))
+void Encryption::EncryptFileHashed(std::istream& input, std::ostream& output, const uint64_t& len, Content& content, const ContentHashes& hashes) {
+    static constexpr uint32_t encryptedBlockSize = 0x400 + BlockPipeline::BLOCK_SIZE; // hashes + data
+
+    // There is always a block after the last full one, even if it's empty
+    const uint32_t numBlocks = static_cast<uint32_t>(len / BlockPipeline::BLOCK_SIZE) + 1;
+    BlockPipeline::run(input, numBlocks, encryptedBlockSize,
+        [&](const char* block, const uint32_t& blockIndex, char* encrypted) {
+            EncryptBlockHashed(block, blockIndex, hashes, content, encrypted);
+        },
+        [&](const char* encrypted, const uint32_t& firstBlock, const uint32_t& numEncrypted) {
+            output.write(encrypted, static_cast<std::streamsize>(numEncrypted) * encryptedBlockSize);
+
+            // Update progress dialogue
+            const uint32_t blocksDone = firstBlock + numEncrypted;
+            if (blocksDone > 1000)
+            {
+                UPDATE_DIALOG_VALUE(149 + (int)(((float) (static_cast<uint64_t>(blocksDone) * BlockPipeline::BLOCK_SIZE) / (float) len) * 50.0f))
+            }
         }
-    } while (input);
+    );
     content.size = output.tellp();
 }
 
-std::stringstream Encryption::EncryptChunkHashed(const std::string& buffer, const uint32_t &block, ContentHashes &hashes, const Content &content) {
+// Each block is its hashes encrypted with the content ID as the IV, then its data
+// encrypted with part of its own H0 hash as the IV
+void Encryption::EncryptBlockHashed(const char* block, const uint32_t& blockIndex, const ContentHashes& hashes, const Content& content, char* output) const {
     const uint16_t& write = Utility::Endian::toPlatform(eType::Big, static_cast<const uint16_t>(content.id));
-    iv = IV{0};
-    std::memcpy(iv.data(), &write, sizeof(uint16_t));
+    IV hashesIV{0};
+    std::memcpy(hashesIV.data(), &write, sizeof(uint16_t));
 
-    std::string decryptedHashes = hashes.GetHashForBlock(block);
+    std::string decryptedHashes = hashes.GetHashForBlock(blockIndex);
 
     decryptedHashes[1] ^= static_cast<uint8_t>(content.id);
-
-    std::stringstream outputStream(Encrypt(decryptedHashes));
+    Encrypt(decryptedHashes.data(), decryptedHashes.size(), hashesIV, output);
     decryptedHashes[1] ^= static_cast<uint8_t>(content.id);
-    const uint32_t iv_start = (block % 16) * 20;
-
-    std::copy(decryptedHashes.begin() + iv_start, decryptedHashes.begin() + iv_start + 16, iv.begin());
 
-    outputStream << Encrypt(buffer).str();
+    const uint32_t iv_start = (blockIndex % 16) * 20;
+    IV blockIV;
+    std::copy(decryptedHashes.begin() + iv_start, decryptedHashes.begin() + iv_start + 16, blockIV.begin());
 
-    return outputStream;
+    Encrypt(block, BlockPipeline::BLOCK_SIZE, blockIV, output + decryptedHashes.size());
 }
 
-std::stringstream Encryption::Encrypt(const std::string& input, const uint32_t& size) {
-    const uint32_t inputSize = ((size != 0) ? size : input.size());
+void Encryption::Encrypt(const char* input, const uint32_t& size, const IV& iv_, char* output) const {
+    AES aes(AESKeyLength::AES_128); // only holds the key length, cheaper to make than to share between threads
 
-    const uint8_t* data = aes.EncryptCBC(reinterpret_cast<const uint8_t*>(&input[0]), inputSize, key.data(), iv.data());
-    std::stringstream ret;
-    ret.write(reinterpret_cast<const char*>(data), inputSize);
-    delete[] data;
-    return ret;
+    const std::unique_ptr<uint8_t[]> data(aes.EncryptCBC(reinterpret_cast<const uint8_t*>(input), size, key.data(), iv_.data()));
+    std::memcpy(output, data.get(), size);
 }
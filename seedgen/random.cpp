@@ -1,7 +1,69 @@
 #include "random.hpp"
 
-static bool init = false;
-static Generator_t generator;
+// Each thread draws from its own default context unless a generation has
+// made a different context current with a ScopedRandomContext
+static thread_local RandomContext defaultContext;
+static thread_local RandomContext* currentContext = nullptr;
+
+RandomContext::RandomContext(Seed_t seed)
+{
+    init(seed);
+}
+
+void RandomContext::init(Seed_t seed)
+{
+    initialized = true;
+    generator = Generator_t{seed};
+}
+
+void RandomContext::initIfNeeded()
+{
+    if (!initialized)
+    {
+        // No seed given, get a random number from device to seed
+        const Seed_t& seed = static_cast<Seed_t>(std::random_device{}());
+        init(seed);
+    }
+}
+
+// Returns a random integer in range [min, max-1]
+uint32_t RandomContext::random(int min, int max)
+{
+    initIfNeeded();
+
+    const auto& number = generator();
+    return min + (number % (max - min));
+}
+
+// Returns a random floating point number in [0.0, 1.0]
+double RandomContext::randomDouble()
+{
+    initIfNeeded();
+
+    const auto& number = generator();
+    return (double) number / (double) generator.max();
+}
+
+Generator_t& RandomContext::getGenerator()
+{
+    return generator;
+}
+
+ScopedRandomContext::ScopedRandomContext(RandomContext& context) :
+    previous(currentContext)
+{
+    currentContext = &context;
+}
+
+ScopedRandomContext::~ScopedRandomContext()
+{
+    currentContext = previous;
+}
+
+RandomContext& GetRandomContext()
+{
+    return currentContext != nullptr ? *currentContext : defaultContext;
+}
 
 Seed_t seedFromString(const std::string& str) {
     // https://en.wikipedia.org/wiki/Fowler%E2%80%93Noll%E2%80%93Vo_hash_function#FNV-1a_hash (64-bit)
@@ -14,42 +76,25 @@ Seed_t seedFromString(const std::string& str) {
     return hash;
 }
 
-// Initialize with seed specified
+// Initialize the current context with seed specified
 void Random_Init(Seed_t seed)
 {
-    init = true;
-    generator = Generator_t{seed};
+    GetRandomContext().init(seed);
 }
 
 // Returns a random integer in range [min, max-1]
 uint32_t Random(int min, int max)
 {
-    if (!init)
-    {
-        // No seed given, get a random number from device to seed
-        const Seed_t& seed = static_cast<Seed_t>(std::random_device{}());
-        Random_Init(seed);
-    }
-
-    const auto& number = generator();
-    return min + (number % (max - min));
+    return GetRandomContext().random(min, max);
 }
 
 // Returns a random floating point number in [0.0, 1.0]
 double RandomDouble()
 {
-    if (!init)
-    {
-        // No seed given, get a random number from device to seed
-        const Seed_t& seed = static_cast<Seed_t>(std::random_device{}());
-        Random_Init(seed);
-    }
-
-    const auto& number = generator();
-    return (double) number / (double) generator.max(); 
+    return GetRandomContext().randomDouble();
 }
 
 Generator_t& GetGenerator()
 {
-    return generator;
+    return GetRandomContext().getGenerator();
 }
@@ -10,6 +10,44 @@
 using Generator_t = std::mt19937_64;
 using Seed_t = Generator_t::result_type;
 
+// The state for one stream of random numbers. Each thread has its own default
+// context, and a generation can make its own context current with a
+// ScopedRandomContext so that several seeds can be generated at once
+class RandomContext
+{
+public:
+    RandomContext() = default;
+    explicit RandomContext(Seed_t seed);
+
+    void init(Seed_t seed);
+    uint32_t random(int min, int max);
+    double randomDouble();
+    Generator_t& getGenerator();
+
+private:
+    void initIfNeeded();
+
+    bool initialized = false;
+    Generator_t generator;
+};
+
+// Makes the given context the one used by Random() and the pool functions below
+// on the current thread until this object goes out of scope
+class ScopedRandomContext
+{
+public:
+    explicit ScopedRandomContext(RandomContext& context);
+    ~ScopedRandomContext();
+
+    ScopedRandomContext(const ScopedRandomContext&) = delete;
+    ScopedRandomContext& operator=(const ScopedRandomContext&) = delete;
+
+private:
+    RandomContext* previous = nullptr;
+};
+
+RandomContext& GetRandomContext();
+
 Seed_t seedFromString(const std::string& str);
 void Random_Init(Seed_t seed);
 uint32_t Random(int min, int max);
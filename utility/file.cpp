@@ -1,6 +1,7 @@
 #include "file.hpp"
 
 #include <cstring>
+#include <algorithm>
 #include <regex>
 #include <filesystem>
 
@@ -10,6 +11,17 @@
 #include <utility/thread_local.hpp>
 
 
+#ifdef __linux__
+    #include <fcntl.h>
+    #include <sys/ioctl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+    #include <linux/fs.h>
+#elif defined(__APPLE__)
+    #include <sys/clonefile.h>
+#endif
+
 #if defined(QT_GUI) && defined(EMBED_DATA)
     #include <QResource>
     #include <QFile>
@@ -73,6 +85,62 @@ namespace Utility {
         #endif
     }
 
+    #ifdef __linux__
+    static bool cloneFile(const fspath& from, const fspath& to) {
+        const int src = ::open(from.c_str(), O_RDONLY | O_CLOEXEC);
+        if (src == -1) return false;
+
+        struct stat fileStat;
+        if (fstat(src, &fileStat) != 0) {
+            ::close(src);
+            return false;
+        }
+
+        const int dst = ::open(to.c_str(), O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, fileStat.st_mode & 0777);
+        if (dst == -1) {
+            ::close(src);
+            return false;
+        }
+
+        const bool cloned = ioctl(dst, FICLONE, src) == 0;
+        ::close(dst);
+        ::close(src);
+
+        // Filesystems without reflinks leave an empty file behind
+        if (!cloned) {
+            std::error_code ec;
+            std::filesystem::remove(to, ec);
+        }
+        return cloned;
+    }
+    #elif defined(__APPLE__)
+    static bool cloneFile(const fspath& from, const fspath& to) {
+        return clonefile(from.c_str(), to.c_str(), 0) == 0;
+    }
+    #endif
+
+    bool linkOrCopyFile(const fspath& from, const fspath& to) {
+        #ifdef DEVKITPRO
+            return copy_file(from, to);
+        #else
+            // Never write through whatever was here before, it could be a link to another file
+            std::error_code ec;
+            std::filesystem::remove(to, ec);
+
+            #if defined(__linux__) || defined(__APPLE__)
+                if (cloneFile(from, to)) return true;
+            #endif
+
+            if (std::filesystem::create_hard_link(from, to, ec); !ec) return true;
+
+            if (!std::filesystem::copy_file(from, to, std::filesystem::copy_options::overwrite_existing, ec)) {
+                ErrorLog::getInstance().log("Failed to copy " + Utility::toUtf8String(from) + ": " + ec.message());
+                return false;
+            }
+            return true;
+        #endif
+    }
+
     bool copy(const fspath& from, const fspath& to) {
         #ifdef DEVKITPRO
             // Based on https://github.com/emiyl/dumpling/blob/12935ede46e9720fdec915cdb430d10eb7df54a7/source/app/dumping.cpp#L208
@@ -156,7 +224,7 @@ namespace Utility {
         // Otherwise load it normally
         auto ss = std::stringstream{};
         if(const auto err = getFileContents(filename, ss); err != 0) return err;
-        fileContents = ss.str();
+        fileContents = std::move(ss).str();
         return 0;
     }
 
@@ -176,9 +244,159 @@ namespace Utility {
             fileContents.write(buf.get().getBuffer(), file.gcount());
         }
         #else
-            fileContents << file.rdbuf();
+            // Size the buffer up front and read straight into it so it isn't grown and copied along the way
+            file.seekg(0, std::ios::end);
+            std::string data(static_cast<size_t>(file.tellg()), '\0');
+            file.seekg(0, std::ios::beg);
+            if (!file.read(data.data(), data.size()))
+            {
+                ErrorLog::getInstance().log("Unable to read file \"" + Utility::toUtf8String(filename) + "\"");
+                return 1;
+            }
+            fileContents.str(std::move(data));
+        #endif
+
+        return 0;
+    }
+
+    MappedFile::~MappedFile() {
+        close();
+    }
+
+    int MappedFile::open(const fspath& filename) {
+        close();
+
+        #ifdef __linux__
+            const int fd = ::open(filename.c_str(), O_RDONLY | O_CLOEXEC);
+            if (fd == -1)
+            {
+                ErrorLog::getInstance().log("Unable to open file \"" + Utility::toUtf8String(filename) + "\"");
+                return 1;
+            }
+
+            struct stat fileStat;
+            if (fstat(fd, &fileStat) != 0)
+            {
+                ErrorLog::getInstance().log("Unable to get size of file \"" + Utility::toUtf8String(filename) + "\"");
+                ::close(fd);
+                return 1;
+            }
+
+            // Empty files can't be mapped, they just get an empty view
+            size = static_cast<size_t>(fileStat.st_size);
+            if (size > 0)
+            {
+                mapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+                if (mapping == MAP_FAILED)
+                {
+                    ErrorLog::getInstance().log("Unable to map file \"" + Utility::toUtf8String(filename) + "\"");
+                    mapping = nullptr;
+                    size = 0;
+                    ::close(fd);
+                    return 1;
+                }
+                madvise(mapping, size, MADV_SEQUENTIAL);
+            }
+            ::close(fd); // the mapping stays valid without it
+        #else
+            if (const auto err = getFileContents(filename, contents); err != 0) return err;
         #endif
 
+        opened = true;
         return 0;
     }
+
+    void MappedFile::close() {
+        #ifdef __linux__
+            if (mapping != nullptr) munmap(mapping, size);
+            mapping = nullptr;
+            size = 0;
+        #else
+            contents = std::string();
+        #endif
+        opened = false;
+    }
+
+    std::string_view MappedFile::view() const {
+        #ifdef __linux__
+            return std::string_view(static_cast<const char*>(mapping), size);
+        #else
+            return contents;
+        #endif
+    }
+
+    // The get area is never written through, so it can point at read-only memory
+    ViewStream::ViewBuffer::ViewBuffer(std::string_view data) {
+        char* start = const_cast<char*>(data.data());
+        setg(start, start, start + data.size());
+    }
+
+    ViewStream::ViewBuffer::pos_type ViewStream::ViewBuffer::seekoff(off_type off, std::ios::seekdir dir, std::ios::openmode which) {
+        if (!(which & std::ios::in)) return pos_type(off_type(-1));
+
+        off_type pos = off;
+        if (dir == std::ios::cur) pos += gptr() - eback();
+        else if (dir == std::ios::end) pos += egptr() - eback();
+
+        if (pos < 0 || pos > egptr() - eback()) return pos_type(off_type(-1));
+        setg(eback(), eback() + pos, egptr());
+        return pos_type(pos);
+    }
+
+    ViewStream::ViewBuffer::pos_type ViewStream::ViewBuffer::seekpos(pos_type pos, std::ios::openmode which) {
+        return seekoff(off_type(pos), std::ios::beg, which);
+    }
+
+    ViewStream::ViewStream(std::string_view data) :
+        std::istream(nullptr),
+        buffer(data)
+    {
+        rdbuf(&buffer);
+    }
+
+    BufferStream::BufferBuffer::BufferBuffer(std::string& out) :
+        data(out)
+    {}
+
+    BufferStream::BufferBuffer::int_type BufferStream::BufferBuffer::overflow(int_type ch) {
+        if (traits_type::eq_int_type(ch, traits_type::eof())) return traits_type::not_eof(ch);
+
+        const char c = traits_type::to_char_type(ch);
+        xsputn(&c, 1);
+        return ch;
+    }
+
+    std::streamsize BufferStream::BufferBuffer::xsputn(const char* s, std::streamsize count) {
+        // Overwrite whatever is already past the position, anything left over goes on the end
+        const size_t len = static_cast<size_t>(count);
+        const size_t overlap = std::min(len, data.size() - pos);
+        data.replace(pos, overlap, s, overlap);
+        data.append(s + overlap, len - overlap);
+        pos += len;
+        return count;
+    }
+
+    BufferStream::BufferBuffer::pos_type BufferStream::BufferBuffer::seekoff(off_type off, std::ios::seekdir dir, std::ios::openmode which) {
+        if (!(which & std::ios::out)) return pos_type(off_type(-1));
+
+        off_type newPos = off;
+        if (dir == std::ios::cur) newPos += pos;
+        else if (dir == std::ios::end) newPos += data.size();
+
+        // Same as a stringstream, seeking past the end fails (Utility::seek pads it instead)
+        if (newPos < 0 || newPos > static_cast<off_type>(data.size())) return pos_type(off_type(-1));
+        pos = static_cast<size_t>(newPos);
+        return pos_type(newPos);
+    }
+
+    BufferStream::BufferBuffer::pos_type BufferStream::BufferBuffer::seekpos(pos_type pos_, std::ios::openmode which) {
+        return seekoff(off_type(pos_), std::ios::beg, which);
+    }
+
+    BufferStream::BufferStream(std::string& out) :
+        std::ostream(nullptr),
+        buffer(out)
+    {
+        rdbuf(&buffer);
+    }
 }
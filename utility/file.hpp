@@ -4,6 +4,7 @@
 #include <fstream>
 #include <sstream>
 #include <filesystem>
+#include <string_view>
 
 #include <utility/path.hpp>
 
@@ -109,9 +110,92 @@ namespace Utility {
 
     bool copy_file(const fspath& from, const fspath& to);
 
+    // Give to the same contents as from without copying them where possible: a copy-on-write
+    // clone if the filesystem supports it, otherwise a hard link, otherwise a normal copy.
+    // A hard linked file shares its data with the original, so it has to be removed before
+    // anything new is written to it
+    bool linkOrCopyFile(const fspath& from, const fspath& to);
+
     bool copy(const fspath& from, const fspath& to);
 
     int getFileContents(const fspath& filename, std::string& fileContents, bool resourceFile = false);
 
     int getFileContents(const fspath& filename, std::stringstream& fileContents);
+
+    // Read-only copy of a whole file. On Linux the file is mapped instead of read,
+    // so it comes straight from the page cache without a second copy on the heap.
+    // Other platforms fall back to reading it into memory
+    class MappedFile {
+    public:
+        MappedFile() = default;
+        ~MappedFile();
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        // Without a real mapping, open() reads the whole file into memory instead
+        #ifdef __linux__
+            static constexpr bool mapsFiles = true;
+        #else
+            static constexpr bool mapsFiles = false;
+        #endif
+
+        int open(const fspath& filename);
+        void close();
+        bool isOpen() const { return opened; }
+        std::string_view view() const;
+
+    private:
+        #ifdef __linux__
+            void* mapping = nullptr;
+            size_t size = 0;
+        #else
+            std::string contents;
+        #endif
+        bool opened = false;
+    };
+
+    // Input stream over memory owned by something else (like a MappedFile), so
+    // parsers that take a stream can read it in place
+    class ViewStream : public std::istream {
+    public:
+        explicit ViewStream(std::string_view data);
+
+    private:
+        class ViewBuffer : public std::streambuf {
+        public:
+            explicit ViewBuffer(std::string_view data);
+
+        protected:
+            pos_type seekoff(off_type off, std::ios::seekdir dir, std::ios::openmode which) override;
+            pos_type seekpos(pos_type pos, std::ios::openmode which) override;
+        };
+
+        ViewBuffer buffer;
+    };
+
+    // Output stream that writes straight into a string owned by the caller. It seeks and
+    // overwrites like a stringstream, but the finished data can be moved out of the string
+    // instead of being copied out of the stream
+    class BufferStream : public std::ostream {
+    public:
+        explicit BufferStream(std::string& out);
+
+    private:
+        class BufferBuffer : public std::streambuf {
+        public:
+            explicit BufferBuffer(std::string& out);
+
+        protected:
+            int_type overflow(int_type ch) override;
+            std::streamsize xsputn(const char* s, std::streamsize count) override;
+            pos_type seekoff(off_type off, std::ios::seekdir dir, std::ios::openmode which) override;
+            pos_type seekpos(pos_type pos, std::ios::openmode which) override;
+
+        private:
+            std::string& data;
+            size_t pos = 0;
+        };
+
+        BufferBuffer buffer;
+    };
 }
@@ -8,9 +8,11 @@
 
 enum struct DataIDs : uint32_t {
 #ifdef DEVKITPRO
-    FILE_OP_BUFFER = OS_THREAD_SPECIFIC_0
+    FILE_OP_BUFFER = OS_THREAD_SPECIFIC_0,
+    YAZ0_WORK_BUFFER = OS_THREAD_SPECIFIC_1
 #else
-    FILE_OP_BUFFER = 0
+    FILE_OP_BUFFER = 0,
+    YAZ0_WORK_BUFFER = 1
 #endif
 };
 